@@ -347,6 +347,30 @@ static int make_decode_table(cab_ULONG nsyms, cab_ULONG nbits,
   return 0;
 }
 
+/*************************************************************************
+ * copy_match (internal)
+ *
+ * Copy match data within the window. The source may overlap the destination,
+ * in which case the bytes just copied are repeated.
+ */
+static inline cab_UBYTE *copy_match(cab_UBYTE *dest, const cab_UBYTE *src, int len)
+{
+  int i;
+
+  if (len >= 16) {
+    if (src > dest || dest - src >= len) {
+      memmove(dest, src, len);
+      return dest + len;
+    }
+    if (dest - src == 1) {
+      memset(dest, *src, len);
+      return dest + len;
+    }
+  }
+  for (i = 0; i < len; i++) dest[i] = src[i];
+  return dest + (len > 0 ? len : 0);
+}
+
 /*************************************************************************
  * checksum (internal)
  */
@@ -1124,10 +1148,9 @@ static cab_LONG fdi_Zipinflate_codes(const struct Ziphuft *tl, const struct Ziph
         e = ZIPWSIZE - max(d, w);
         e = min(e, n);
         n -= e;
-        do
-        {
-          CAB(outbuf)[w++] = CAB(outbuf)[d++];
-        } while (--e);
+        copy_match(CAB(outbuf) + w, CAB(outbuf) + d, e);
+        w += e;
+        d += e;
       } while (n);
     }
   }
@@ -1530,14 +1553,14 @@ static int QTMfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
         if (copy_length < match_length) {
           match_length -= copy_length;
           window_posn += copy_length;
-          while (copy_length-- > 0) *rundest++ = *runsrc++;
+          rundest = copy_match(rundest, runsrc, copy_length);
           runsrc = window;
         }
       }
       window_posn += match_length;
 
       /* copy match data - no worries about destination wraps */
-      while (match_length-- > 0) *rundest++ = *runsrc++;
+      copy_match(rundest, runsrc, match_length);
     }
   } /* while (togo > 0) */
 
@@ -1768,14 +1791,14 @@ static int LZXfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
               if (copy_length < match_length) {
                 match_length -= copy_length;
                 window_posn += copy_length;
-                while (copy_length-- > 0) *rundest++ = *runsrc++;
+                rundest = copy_match(rundest, runsrc, copy_length);
                 runsrc = window;
               }
             }
             window_posn += match_length;
 
             /* copy match data - no worries about destination wraps */
-            while (match_length-- > 0) *rundest++ = *runsrc++;
+            copy_match(rundest, runsrc, match_length);
           }
         }
         break;
@@ -1857,14 +1880,14 @@ static int LZXfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
               if (copy_length < match_length) {
                 match_length -= copy_length;
                 window_posn += copy_length;
-                while (copy_length-- > 0) *rundest++ = *runsrc++;
+                rundest = copy_match(rundest, runsrc, copy_length);
                 runsrc = window;
               }
             }
             window_posn += match_length;
 
             /* copy match data - no worries about destination wraps */
-            while (match_length-- > 0) *rundest++ = *runsrc++;
+            copy_match(rundest, runsrc, match_length);
           }
         }
         break;
@@ -20,10 +20,13 @@
 
 #define COBJMACROS
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include "wine/debug.h"
 
 #include "d3dcompiler_private.h"
+#include "winreg.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3dcompiler);
 
@@ -397,6 +400,426 @@ HRESULT WINAPI D3DAssemble(const void *data, SIZE_T datasize, const char *filena
     return hr;
 }
 
+/* Persistent cache of compiled HLSL shaders.
+ *
+ * Entries are stored in %LOCALAPPDATA%\wine\d3dcompiler, one file per
+ * shader, named after a hash of everything which can influence the compiler
+ * output, including the compiler version. The complete key is stored in the
+ * file as well and compared on lookup, so hash collisions are harmless.
+ * Shaders which use #include are never stored, since the included files may
+ * change between runs. The data is checksummed, so that damaged entries are
+ * just compiled again.
+ *
+ * The cache is disabled by default. It is enabled by setting its size in MiB
+ * in the "ShaderCacheSize" DWORD value of HKCU\Software\Wine\Direct3D. When
+ * that size is exceeded, the least recently used entries are removed. */
+
+#define SHADER_CACHE_MAGIC 0x43434457 /* WDCC */
+#define SHADER_CACHE_VERSION 2
+
+struct shader_cache_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t key_size;
+    uint32_t messages_size;
+    uint32_t code_size;
+    uint32_t padding;
+    uint64_t checksum;
+};
+
+struct shader_cache_key
+{
+    BYTE *data;
+    size_t size, capacity;
+    uint64_t hash;
+};
+
+static struct
+{
+    WCHAR path[MAX_PATH];
+    LONG64 size, max_size;
+    LONG hits, misses, stores;
+} shader_cache;
+
+static CRITICAL_SECTION shader_cache_cs;
+static CRITICAL_SECTION_DEBUG shader_cache_cs_debug =
+{
+    0, 0, &shader_cache_cs,
+    { &shader_cache_cs_debug.ProcessLocksList,
+      &shader_cache_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": shader_cache_cs") }
+};
+static CRITICAL_SECTION shader_cache_cs = { &shader_cache_cs_debug, -1, 0, 0, 0, 0 };
+
+static BOOL is_shader_cache_file(const WIN32_FIND_DATAW *data)
+{
+    return !(data->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && !wcschr(data->cFileName, '.');
+}
+
+static uint64_t shader_cache_hash(uint64_t hash, const void *data, size_t size)
+{
+    const BYTE *ptr = data;
+    size_t i;
+
+    /* FNV-1a */
+    for (i = 0; i < size; ++i)
+        hash = (hash ^ ptr[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+static BOOL WINAPI shader_cache_init(INIT_ONCE *once, void *param, void **context)
+{
+    DWORD len, type, size = 0, value_size = sizeof(size);
+    WCHAR pattern[MAX_PATH];
+    WIN32_FIND_DATAW data;
+    HANDLE find;
+    HKEY key;
+
+    /* @@ Wine registry key: HKCU\Software\Wine\Direct3D */
+    if (!RegOpenKeyExW(HKEY_CURRENT_USER, L"Software\\Wine\\Direct3D", 0, KEY_QUERY_VALUE, &key))
+    {
+        if (RegQueryValueExW(key, L"ShaderCacheSize", NULL, &type, (BYTE *)&size, &value_size) || type != REG_DWORD)
+            size = 0;
+        RegCloseKey(key);
+    }
+    if (!size)
+    {
+        TRACE("Shader cache is disabled.\n");
+        return TRUE;
+    }
+
+    len = ExpandEnvironmentStringsW(L"%LOCALAPPDATA%\\wine", shader_cache.path, ARRAY_SIZE(shader_cache.path));
+    if (!len || len > ARRAY_SIZE(shader_cache.path) - 16 || shader_cache.path[0] == '%')
+    {
+        WARN("Failed to find the local application data directory.\n");
+        shader_cache.path[0] = 0;
+        return TRUE;
+    }
+    CreateDirectoryW(shader_cache.path, NULL);
+    wcscat(shader_cache.path, L"\\d3dcompiler");
+    if (!CreateDirectoryW(shader_cache.path, NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        WARN("Failed to create shader cache directory %s, error %lu.\n",
+                debugstr_w(shader_cache.path), GetLastError());
+        shader_cache.path[0] = 0;
+        return TRUE;
+    }
+
+    swprintf(pattern, ARRAY_SIZE(pattern), L"%s\\*", shader_cache.path);
+    if ((find = FindFirstFileW(pattern, &data)) != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            if (is_shader_cache_file(&data))
+                shader_cache.size += ((LONG64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        } while (FindNextFileW(find, &data));
+        FindClose(find);
+    }
+    shader_cache.max_size = (LONG64)size << 20;
+
+    TRACE("Using shader cache %s, size %I64d, max size %I64d.\n",
+            debugstr_w(shader_cache.path), shader_cache.size, shader_cache.max_size);
+    return TRUE;
+}
+
+static void shader_cache_key_append(struct shader_cache_key *key, const void *data, size_t size)
+{
+    size_t needed = key->size + sizeof(uint64_t) + size;
+    uint64_t data_size = size;
+
+    if (!key->data)
+        return;
+
+    if (needed > key->capacity)
+    {
+        size_t capacity = max(needed, key->capacity * 2);
+        BYTE *new_data;
+
+        if (!(new_data = realloc(key->data, capacity)))
+        {
+            free(key->data);
+            key->data = NULL;
+            return;
+        }
+        key->data = new_data;
+        key->capacity = capacity;
+    }
+
+    /* Prefix every field with its size, so that the concatenation is unambiguous. */
+    memcpy(key->data + key->size, &data_size, sizeof(data_size));
+    if (size)
+        memcpy(key->data + key->size + sizeof(data_size), data, size);
+    key->size = needed;
+}
+
+static void shader_cache_key_append_string(struct shader_cache_key *key, const char *str)
+{
+    shader_cache_key_append(key, str, str ? strlen(str) + 1 : 0);
+}
+
+static BOOL shader_cache_key_init(struct shader_cache_key *key, const struct vkd3d_shader_compile_info *info,
+        const D3D_SHADER_MACRO *macros, const char *entry_point, const char *profile, UINT flags,
+        UINT effect_flags, UINT secondary_flags, const void *secondary_data, SIZE_T secondary_data_size)
+{
+    static INIT_ONCE init_once = INIT_ONCE_STATIC_INIT;
+    UINT compiler_version = D3D_COMPILER_VERSION;
+    const D3D_SHADER_MACRO *macro;
+
+    InitOnceExecuteOnce(&init_once, shader_cache_init, NULL, NULL);
+    if (!shader_cache.path[0])
+        return FALSE;
+
+    key->size = 0;
+    key->capacity = 1024 + info->source.size;
+    if (!(key->data = malloc(key->capacity)))
+        return FALSE;
+
+    shader_cache_key_append(key, &compiler_version, sizeof(compiler_version));
+    shader_cache_key_append_string(key, vkd3d_shader_get_version(NULL, NULL));
+    shader_cache_key_append(key, &info->target_type, sizeof(info->target_type));
+    shader_cache_key_append(key, info->source.code, info->source.size);
+    shader_cache_key_append_string(key, info->source_name);
+    shader_cache_key_append_string(key, entry_point);
+    shader_cache_key_append_string(key, profile);
+    shader_cache_key_append(key, &flags, sizeof(flags));
+    shader_cache_key_append(key, &effect_flags, sizeof(effect_flags));
+    shader_cache_key_append(key, &secondary_flags, sizeof(secondary_flags));
+    shader_cache_key_append(key, secondary_data, secondary_data_size);
+    for (macro = macros; macro && macro->Name; ++macro)
+    {
+        shader_cache_key_append_string(key, macro->Name);
+        shader_cache_key_append_string(key, macro->Definition);
+    }
+
+    if (!key->data)
+        return FALSE;
+
+    key->hash = shader_cache_hash(0xcbf29ce484222325ull, key->data, key->size);
+
+    return TRUE;
+}
+
+static void shader_cache_get_filename(const struct shader_cache_key *key, WCHAR *filename, size_t count)
+{
+    swprintf(filename, count, L"%s\\%016I64x", shader_cache.path, key->hash);
+}
+
+static BOOL shader_cache_load(const struct shader_cache_key *key, ID3DBlob **shader_blob,
+        ID3DBlob **messages_blob)
+{
+    const struct shader_cache_header *header;
+    WCHAR filename[MAX_PATH];
+    LARGE_INTEGER file_size;
+    LONG hits, misses;
+    FILETIME now;
+    BYTE *data = NULL;
+    BOOL ret = FALSE;
+    DWORD read;
+    HANDLE file;
+
+    shader_cache_get_filename(key, filename, ARRAY_SIZE(filename));
+    file = CreateFileW(filename, GENERIC_READ | FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, 0, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        goto done;
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < sizeof(*header)
+            || file_size.QuadPart > shader_cache.max_size || !(data = malloc(file_size.QuadPart))
+            || !ReadFile(file, data, file_size.QuadPart, &read, NULL) || read != file_size.QuadPart)
+        goto done;
+
+    header = (const struct shader_cache_header *)data;
+    if (header->magic != SHADER_CACHE_MAGIC || header->version != SHADER_CACHE_VERSION
+            || header->key_size != key->size
+            || (UINT64)sizeof(*header) + header->key_size + header->messages_size + header->code_size
+            != file_size.QuadPart
+            || memcmp(header + 1, key->data, key->size)
+            || header->checksum != shader_cache_hash(0xcbf29ce484222325ull,
+            (const BYTE *)(header + 1) + header->key_size, header->messages_size + header->code_size))
+        goto done;
+
+    /* Keep track of the last use, for evicting old entries. */
+    GetSystemTimeAsFileTime(&now);
+    SetFileTime(file, NULL, NULL, &now);
+
+    if (messages_blob && header->messages_size)
+    {
+        if (FAILED(D3DCreateBlob(header->messages_size, messages_blob)))
+            goto done;
+        memcpy(ID3D10Blob_GetBufferPointer(*messages_blob),
+                (const BYTE *)(header + 1) + header->key_size, header->messages_size);
+    }
+    if (shader_blob)
+    {
+        if (FAILED(D3DCreateBlob(header->code_size, shader_blob)))
+        {
+            if (messages_blob && *messages_blob)
+            {
+                ID3D10Blob_Release(*messages_blob);
+                *messages_blob = NULL;
+            }
+            goto done;
+        }
+        memcpy(ID3D10Blob_GetBufferPointer(*shader_blob),
+                (const BYTE *)(header + 1) + header->key_size + header->messages_size, header->code_size);
+    }
+    ret = TRUE;
+
+done:
+    if (file != INVALID_HANDLE_VALUE)
+        CloseHandle(file);
+    free(data);
+
+    if (ret)
+    {
+        hits = InterlockedIncrement(&shader_cache.hits);
+        TRACE("Shader cache hit, %ld hits, %ld misses.\n", hits, ReadNoFence(&shader_cache.misses));
+    }
+    else
+    {
+        misses = InterlockedIncrement(&shader_cache.misses);
+        TRACE("Shader cache miss, %ld hits, %ld misses.\n", ReadNoFence(&shader_cache.hits), misses);
+    }
+    return ret;
+}
+
+struct shader_cache_file
+{
+    WCHAR name[17];
+    FILETIME time;
+    LONG64 size;
+};
+
+static int __cdecl shader_cache_file_compare(const void *a, const void *b)
+{
+    const struct shader_cache_file *file_a = a, *file_b = b;
+
+    return CompareFileTime(&file_a->time, &file_b->time);
+}
+
+/* Remove the least recently used entries until the cache is at three
+ * quarters of its maximum size. */
+static void shader_cache_evict(void)
+{
+    struct shader_cache_file *files = NULL, *new_files;
+    size_t count = 0, capacity = 0, i;
+    WCHAR path[MAX_PATH];
+    WIN32_FIND_DATAW data;
+    LONG64 size = 0;
+    HANDLE find;
+
+    EnterCriticalSection(&shader_cache_cs);
+
+    if (shader_cache.size <= shader_cache.max_size)
+        goto done;
+
+    swprintf(path, ARRAY_SIZE(path), L"%s\\*", shader_cache.path);
+    if ((find = FindFirstFileW(path, &data)) == INVALID_HANDLE_VALUE)
+        goto done;
+    do
+    {
+        if (!is_shader_cache_file(&data) || wcslen(data.cFileName) >= ARRAY_SIZE(files->name))
+            continue;
+        if (count == capacity)
+        {
+            capacity = max(capacity * 2, 64);
+            if (!(new_files = realloc(files, capacity * sizeof(*files))))
+                break;
+            files = new_files;
+        }
+        wcscpy(files[count].name, data.cFileName);
+        files[count].time = data.ftLastWriteTime;
+        files[count].size = ((LONG64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        size += files[count++].size;
+    } while (FindNextFileW(find, &data));
+    FindClose(find);
+
+    qsort(files, count, sizeof(*files), shader_cache_file_compare);
+    for (i = 0; i < count && size > shader_cache.max_size / 4 * 3; ++i)
+    {
+        swprintf(path, ARRAY_SIZE(path), L"%s\\%s", shader_cache.path, files[i].name);
+        if (DeleteFileW(path))
+            size -= files[i].size;
+    }
+    TRACE("Evicted %Iu entries, cache size %I64d.\n", i, size);
+    shader_cache.size = size;
+
+done:
+    LeaveCriticalSection(&shader_cache_cs);
+    free(files);
+}
+
+static void shader_cache_store(const struct shader_cache_key *key, const char *messages,
+        const struct vkd3d_shader_code *code)
+{
+    struct shader_cache_header header;
+    WCHAR filename[MAX_PATH], tmp_filename[MAX_PATH];
+    DWORD written;
+    HANDLE file;
+    LONG64 size;
+    LONG stores;
+    BOOL ret;
+
+    header.magic = SHADER_CACHE_MAGIC;
+    header.version = SHADER_CACHE_VERSION;
+    header.key_size = key->size;
+    header.messages_size = messages ? strlen(messages) : 0;
+    header.code_size = code->size;
+    header.padding = 0;
+    header.checksum = shader_cache_hash(0xcbf29ce484222325ull, messages, header.messages_size);
+    header.checksum = shader_cache_hash(header.checksum, code->code, code->size);
+
+    shader_cache_get_filename(key, filename, ARRAY_SIZE(filename));
+    swprintf(tmp_filename, ARRAY_SIZE(tmp_filename), L"%s.%lx.tmp", filename, GetCurrentThreadId());
+
+    /* Write to a temporary file first, so that other processes never see a
+     * partially written entry. */
+    file = CreateFileW(tmp_filename, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return;
+    ret = WriteFile(file, &header, sizeof(header), &written, NULL)
+            && WriteFile(file, key->data, key->size, &written, NULL)
+            && WriteFile(file, messages, header.messages_size, &written, NULL)
+            && WriteFile(file, code->code, code->size, &written, NULL);
+    CloseHandle(file);
+
+    if (!ret || !MoveFileExW(tmp_filename, filename, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write shader cache entry %s, error %lu.\n", debugstr_w(filename), GetLastError());
+        DeleteFileW(tmp_filename);
+        return;
+    }
+
+    stores = InterlockedIncrement(&shader_cache.stores);
+    TRACE("Stored shader cache entry %s, %ld entries stored.\n", debugstr_w(filename), stores);
+    size = sizeof(header) + key->size + header.messages_size + code->size;
+    if (InterlockedExchangeAdd64(&shader_cache.size, size) + size > shader_cache.max_size)
+        shader_cache_evict();
+}
+
+struct compile_include_context
+{
+    ID3DInclude *include;
+    BOOL used;
+};
+
+static int open_compile_include(const char *filename, bool local, const char *parent_data, void *context,
+        struct vkd3d_shader_code *code)
+{
+    struct compile_include_context *ctx = context;
+
+    ctx->used = TRUE;
+    return open_include(filename, local, parent_data, ctx->include, code);
+}
+
+static void close_compile_include(const struct vkd3d_shader_code *code, void *context)
+{
+    struct compile_include_context *ctx = context;
+
+    close_include(code, ctx->include);
+}
+
 HRESULT WINAPI D3DCompile2(const void *data, SIZE_T data_size, const char *filename,
         const D3D_SHADER_MACRO *macros, ID3DInclude *include, const char *entry_point,
         const char *profile, UINT flags, UINT effect_flags, UINT secondary_flags,
@@ -405,13 +828,16 @@ HRESULT WINAPI D3DCompile2(const void *data, SIZE_T data_size, const char *filen
 {
     struct d3dcompiler_include_from_file include_from_file;
     struct vkd3d_shader_preprocess_info preprocess_info;
+    struct compile_include_context include_context;
     struct vkd3d_shader_hlsl_source_info hlsl_info;
     struct vkd3d_shader_compile_option options[3];
     struct vkd3d_shader_compile_info compile_info;
     struct vkd3d_shader_compile_option *option;
     struct vkd3d_shader_code byte_code;
+    struct shader_cache_key cache_key;
     const D3D_SHADER_MACRO *macro;
     size_t profile_len, i;
+    BOOL use_cache;
     char *messages;
     HRESULT hr;
     int ret;
@@ -501,9 +927,11 @@ HRESULT WINAPI D3DCompile2(const void *data, SIZE_T data_size, const char *filen
         for (macro = macros; macro->Name; ++macro)
             ++preprocess_info.macro_count;
     }
-    preprocess_info.pfn_open_include = open_include;
-    preprocess_info.pfn_close_include = close_include;
-    preprocess_info.include_context = include;
+    include_context.include = include;
+    include_context.used = FALSE;
+    preprocess_info.pfn_open_include = open_compile_include;
+    preprocess_info.pfn_close_include = close_compile_include;
+    preprocess_info.include_context = &include_context;
 
     hlsl_info.type = VKD3D_SHADER_STRUCTURE_TYPE_HLSL_SOURCE_INFO;
     hlsl_info.next = NULL;
@@ -532,11 +960,28 @@ HRESULT WINAPI D3DCompile2(const void *data, SIZE_T data_size, const char *filen
         option->value = VKD3D_SHADER_COMPILE_OPTION_PACK_MATRIX_COLUMN_MAJOR;
     }
 
+    if ((use_cache = shader_cache_key_init(&cache_key, &compile_info, macros, entry_point, profile,
+            flags, effect_flags, secondary_flags, secondary_data, secondary_data_size)))
+    {
+        if (shader_cache_load(&cache_key, shader_blob, messages_blob))
+        {
+            free(cache_key.data);
+            return S_OK;
+        }
+    }
+
     ret = vkd3d_shader_compile(&compile_info, &byte_code, &messages);
 
     if (ret)
         ERR("Failed to compile shader, vkd3d result %d.\n", ret);
 
+    if (use_cache)
+    {
+        if (!ret && !include_context.used)
+            shader_cache_store(&cache_key, messages, &byte_code);
+        free(cache_key.data);
+    }
+
     if (messages)
     {
         if (*messages && ERR_ON(d3dcompiler))
@@ -1835,10 +1835,263 @@ static void test_no_output_blob(void)
     ok(!errors, "Unexpected errors blob.\n");
 }
 
+static const char shader_cache_source[] =
+    "float4x4 m;\n"
+    "float4 main(float4 pos : POSITION) : POSITION\n"
+    "{\n"
+    "   return mul(pos, m) * VALUE;\n"
+    "}";
+
+static const struct
+{
+    const char *value;
+    unsigned int flags;
+}
+shader_cache_variants[] =
+{
+    {"1.0", 0},
+    {"2.0", 0},
+    {"1.0", D3DCOMPILE_PACK_MATRIX_ROW_MAJOR},
+};
+
+static ID3D10Blob *compile_shader_cache_variant(unsigned int i)
+{
+    const D3D_SHADER_MACRO macros[] = {{"VALUE", shader_cache_variants[i].value}, {NULL, NULL}};
+    ID3D10Blob *blob = NULL, *errors = NULL;
+    HRESULT hr;
+
+    hr = D3DCompile(shader_cache_source, strlen(shader_cache_source), NULL, macros, NULL,
+            "main", "vs_2_0", shader_cache_variants[i].flags, 0, &blob, &errors);
+    ok(hr == S_OK, "Variant %u: got unexpected hr %#lx.\n", i, hr);
+    if (errors)
+        ID3D10Blob_Release(errors);
+    return blob;
+}
+
+static void get_shader_cache_path(WCHAR *path, const WCHAR *filename)
+{
+    GetTempPathW(MAX_PATH, path);
+    lstrcatW(path, L"d3dcompiler_shader_cache");
+    if (filename)
+    {
+        lstrcatW(path, L"\\");
+        lstrcatW(path, filename);
+    }
+}
+
+static void test_shader_cache_child(void)
+{
+    WCHAR path[MAX_PATH], filename[16];
+    ID3D10Blob *blob;
+    DWORD size = 0;
+    char ref[4096];
+    unsigned int i;
+    HANDLE file;
+
+    for (i = 0; i < ARRAY_SIZE(shader_cache_variants); ++i)
+    {
+        if (!(blob = compile_shader_cache_variant(i)))
+            continue;
+
+        swprintf(filename, ARRAY_SIZE(filename), L"ref%u", i);
+        get_shader_cache_path(path, filename);
+        file = CreateFileW(path, GENERIC_READ, 0, NULL, OPEN_EXISTING, 0, NULL);
+        ok(file != INVALID_HANDLE_VALUE, "Failed to open %s, error %lu.\n", wine_dbgstr_w(path), GetLastError());
+        ReadFile(file, ref, sizeof(ref), &size, NULL);
+        CloseHandle(file);
+
+        ok(ID3D10Blob_GetBufferSize(blob) == size
+                && !memcmp(ID3D10Blob_GetBufferPointer(blob), ref, size),
+                "Variant %u: got unexpected byte code.\n", i);
+        ID3D10Blob_Release(blob);
+    }
+}
+
+static void run_shader_cache_child(const char *argv0)
+{
+    STARTUPINFOA si = {.cb = sizeof(si)};
+    PROCESS_INFORMATION pi;
+    char cmdline[MAX_PATH * 2];
+    BOOL ret;
+
+    sprintf(cmdline, "\"%s\" hlsl_d3d9 shader_cache", argv0);
+    ret = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    ok(ret, "Failed to create process, error %lu.\n", GetLastError());
+    if (!ret)
+        return;
+    wait_child_process(pi.hProcess);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+}
+
+/* Alternately flip the last byte of the byte code and cut entries in half. */
+static unsigned int damage_shader_cache(void)
+{
+    WCHAR path[MAX_PATH];
+    unsigned int count = 0;
+    WIN32_FIND_DATAW data;
+    DWORD size, io_size;
+    HANDLE find, file;
+    BYTE byte;
+
+    get_shader_cache_path(path, L"wine\\d3dcompiler\\*");
+    if ((find = FindFirstFileW(path, &data)) == INVALID_HANDLE_VALUE)
+        return 0;
+    do
+    {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            continue;
+
+        get_shader_cache_path(path, L"wine\\d3dcompiler\\");
+        lstrcatW(path, data.cFileName);
+        file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+        ok(file != INVALID_HANDLE_VALUE, "Failed to open %s, error %lu.\n", wine_dbgstr_w(path), GetLastError());
+        size = GetFileSize(file, NULL);
+        if (count++ % 2)
+        {
+            SetFilePointer(file, size / 2, NULL, FILE_BEGIN);
+            SetEndOfFile(file);
+        }
+        else
+        {
+            SetFilePointer(file, -1, NULL, FILE_END);
+            ReadFile(file, &byte, 1, &io_size, NULL);
+            byte ^= 0xff;
+            SetFilePointer(file, -1, NULL, FILE_END);
+            WriteFile(file, &byte, 1, &io_size, NULL);
+        }
+        CloseHandle(file);
+    } while (FindNextFileW(find, &data));
+    FindClose(find);
+
+    return count;
+}
+
+static void delete_shader_cache(void)
+{
+    WCHAR path[MAX_PATH];
+    WIN32_FIND_DATAW data;
+    HANDLE find;
+
+    get_shader_cache_path(path, L"wine\\d3dcompiler\\*");
+    if ((find = FindFirstFileW(path, &data)) != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            get_shader_cache_path(path, L"wine\\d3dcompiler\\");
+            lstrcatW(path, data.cFileName);
+            DeleteFileW(path);
+        } while (FindNextFileW(find, &data));
+        FindClose(find);
+    }
+    get_shader_cache_path(path, L"wine\\d3dcompiler");
+    RemoveDirectoryW(path);
+    get_shader_cache_path(path, L"wine");
+    RemoveDirectoryW(path);
+}
+
+static void test_shader_cache(const char *argv0)
+{
+    WCHAR path[MAX_PATH], filename[16], old_appdata[MAX_PATH];
+    DWORD size = 16, old_size, type, len, disposition, written;
+    ID3D10Blob *blobs[ARRAY_SIZE(shader_cache_variants)] = {0};
+    BOOL has_old_size, has_old_appdata;
+    unsigned int i, count;
+    HANDLE file;
+    HKEY key;
+    LONG ret;
+
+    get_shader_cache_path(path, NULL);
+    CreateDirectoryW(path, NULL);
+
+    for (i = 0; i < ARRAY_SIZE(shader_cache_variants); ++i)
+    {
+        if (!(blobs[i] = compile_shader_cache_variant(i)))
+            goto done;
+
+        swprintf(filename, ARRAY_SIZE(filename), L"ref%u", i);
+        get_shader_cache_path(path, filename);
+        file = CreateFileW(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+        ok(file != INVALID_HANDLE_VALUE, "Failed to create %s, error %lu.\n", wine_dbgstr_w(path), GetLastError());
+        WriteFile(file, ID3D10Blob_GetBufferPointer(blobs[i]), ID3D10Blob_GetBufferSize(blobs[i]), &written, NULL);
+        CloseHandle(file);
+    }
+
+    /* Every variant must compile to different byte code, otherwise a stale
+     * cache hit would go unnoticed. */
+    for (i = 1; i < ARRAY_SIZE(shader_cache_variants); ++i)
+    {
+        ok(ID3D10Blob_GetBufferSize(blobs[i]) != ID3D10Blob_GetBufferSize(blobs[0])
+                || memcmp(ID3D10Blob_GetBufferPointer(blobs[i]), ID3D10Blob_GetBufferPointer(blobs[0]),
+                ID3D10Blob_GetBufferSize(blobs[0])), "Variant %u: got identical byte code.\n", i);
+    }
+
+    /* The cache is a Wine extension; on Windows the children just compile. */
+    if ((ret = RegCreateKeyExW(HKEY_CURRENT_USER, L"Software\\Wine\\Direct3D", 0, NULL, 0,
+            KEY_QUERY_VALUE | KEY_SET_VALUE, NULL, &key, &disposition)))
+    {
+        skip("Failed to create the Direct3D key, error %ld.\n", ret);
+        goto done;
+    }
+    len = sizeof(old_size);
+    has_old_size = !RegQueryValueExW(key, L"ShaderCacheSize", NULL, &type, (BYTE *)&old_size, &len)
+            && type == REG_DWORD;
+    RegSetValueExW(key, L"ShaderCacheSize", 0, REG_DWORD, (BYTE *)&size, sizeof(size));
+
+    has_old_appdata = !!GetEnvironmentVariableW(L"LOCALAPPDATA", old_appdata, ARRAY_SIZE(old_appdata));
+    get_shader_cache_path(path, NULL);
+    SetEnvironmentVariableW(L"LOCALAPPDATA", path);
+
+    /* The first run fills the cache, the second one is served from it. */
+    run_shader_cache_child(argv0);
+    run_shader_cache_child(argv0);
+
+    if (!(count = damage_shader_cache()))
+    {
+        skip("No shader cache entries found.\n");
+    }
+    else
+    {
+        ok(count == ARRAY_SIZE(shader_cache_variants), "Got unexpected entry count %u.\n", count);
+        /* Damaged entries are compiled again. */
+        run_shader_cache_child(argv0);
+    }
+
+    SetEnvironmentVariableW(L"LOCALAPPDATA", has_old_appdata ? old_appdata : NULL);
+    if (has_old_size)
+        RegSetValueExW(key, L"ShaderCacheSize", 0, REG_DWORD, (BYTE *)&old_size, sizeof(old_size));
+    else
+        RegDeleteValueW(key, L"ShaderCacheSize");
+    RegCloseKey(key);
+    if (disposition == REG_CREATED_NEW_KEY)
+        RegDeleteKeyW(HKEY_CURRENT_USER, L"Software\\Wine\\Direct3D");
+    delete_shader_cache();
+
+done:
+    for (i = 0; i < ARRAY_SIZE(shader_cache_variants); ++i)
+    {
+        swprintf(filename, ARRAY_SIZE(filename), L"ref%u", i);
+        get_shader_cache_path(path, filename);
+        DeleteFileW(path);
+        if (blobs[i])
+            ID3D10Blob_Release(blobs[i]);
+    }
+    get_shader_cache_path(path, NULL);
+    RemoveDirectoryW(path);
+}
+
 START_TEST(hlsl_d3d9)
 {
-    char buffer[20];
+    char buffer[20], **argv;
     HMODULE mod;
+    int argc;
+
+    argc = winetest_get_mainargs(&argv);
+    if (argc > 2 && !strcmp(argv[2], "shader_cache"))
+    {
+        test_shader_cache_child();
+        return;
+    }
 
     if (!(mod = LoadLibraryA("d3dx9_36.dll")))
     {
@@ -1869,4 +2122,5 @@ START_TEST(hlsl_d3d9)
     test_fail();
     test_include();
     test_no_output_blob();
+    test_shader_cache(argv[0]);
 }
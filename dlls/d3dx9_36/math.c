@@ -392,17 +392,20 @@ D3DXMATRIX * WINAPI D3DXMatrixLookAtRH(D3DXMATRIX *out, const D3DXVECTOR3 *eye,
 
 D3DXMATRIX* WINAPI D3DXMatrixMultiply(D3DXMATRIX *pout, const D3DXMATRIX *pm1, const D3DXMATRIX *pm2)
 {
+    const D3DXMATRIX m2 = *pm2;
     D3DXMATRIX out;
     int i,j;
 
     TRACE("pout %p, pm1 %p, pm2 %p\n", pout, pm1, pm2);
 
+    /* Each output row is a linear combination of the rows of pm2, which
+     * the compiler can turn into broadcast + multiply-add vector code. */
     for (i=0; i<4; i++)
     {
+        const FLOAT a0 = pm1->m[i][0], a1 = pm1->m[i][1], a2 = pm1->m[i][2], a3 = pm1->m[i][3];
+
         for (j=0; j<4; j++)
-        {
-            out.m[i][j] = pm1->m[i][0] * pm2->m[0][j] + pm1->m[i][1] * pm2->m[1][j] + pm1->m[i][2] * pm2->m[2][j] + pm1->m[i][3] * pm2->m[3][j];
-        }
+            out.m[i][j] = a0 * m2.m[0][j] + a1 * m2.m[1][j] + a2 * m2.m[2][j] + a3 * m2.m[3][j];
     }
 
     *pout = out;
@@ -1290,15 +1293,26 @@ D3DXPLANE* WINAPI D3DXPlaneTransform(D3DXPLANE *pout, const D3DXPLANE *pplane, c
 
 D3DXPLANE* WINAPI D3DXPlaneTransformArray(D3DXPLANE* out, UINT outstride, const D3DXPLANE* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    D3DXMATRIX m;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXPlaneTransform(
-            (D3DXPLANE*)((char*)out + outstride * i),
-            (const D3DXPLANE*)((const char*)in + instride * i),
-            matrix);
+    if (!elements)
+        return out;
+    m = *matrix;
+
+    /* The matrix is copied and each element is read before its result is
+     * written, so the output may alias the input. */
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXPLANE p = *(const D3DXPLANE *)((const char *)in + instride * i);
+        D3DXPLANE *o = (D3DXPLANE *)((char *)out + outstride * i);
+
+        o->a = m.m[0][0] * p.a + m.m[1][0] * p.b + m.m[2][0] * p.c + m.m[3][0] * p.d;
+        o->b = m.m[0][1] * p.a + m.m[1][1] * p.b + m.m[2][1] * p.c + m.m[3][1] * p.d;
+        o->c = m.m[0][2] * p.a + m.m[1][2] * p.b + m.m[2][2] * p.c + m.m[3][2] * p.d;
+        o->d = m.m[0][3] * p.a + m.m[1][3] * p.b + m.m[2][3] * p.c + m.m[3][3] * p.d;
     }
     return out;
 }
@@ -1693,15 +1707,24 @@ D3DXVECTOR4* WINAPI D3DXVec2Transform(D3DXVECTOR4 *pout, const D3DXVECTOR2 *pv,
 
 D3DXVECTOR4* WINAPI D3DXVec2TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR2* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    D3DXMATRIX m;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec2Transform(
-            (D3DXVECTOR4*)((char*)out + outstride * i),
-            (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+    if (!elements)
+        return out;
+    m = *matrix;
+
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR2 v = *(const D3DXVECTOR2 *)((const char *)in + instride * i);
+        D3DXVECTOR4 *o = (D3DXVECTOR4 *)((char *)out + outstride * i);
+
+        o->x = m.m[0][0] * v.x + m.m[1][0] * v.y + m.m[3][0];
+        o->y = m.m[0][1] * v.x + m.m[1][1] * v.y + m.m[3][1];
+        o->z = m.m[0][2] * v.x + m.m[1][2] * v.y + m.m[3][2];
+        o->w = m.m[0][3] * v.x + m.m[1][3] * v.y + m.m[3][3];
     }
     return out;
 }
@@ -1724,15 +1747,24 @@ D3DXVECTOR2* WINAPI D3DXVec2TransformCoord(D3DXVECTOR2 *pout, const D3DXVECTOR2
 
 D3DXVECTOR2* WINAPI D3DXVec2TransformCoordArray(D3DXVECTOR2* out, UINT outstride, const D3DXVECTOR2* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    D3DXMATRIX m;
+    FLOAT norm;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec2TransformCoord(
-            (D3DXVECTOR2*)((char*)out + outstride * i),
-            (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+    if (!elements)
+        return out;
+    m = *matrix;
+
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR2 v = *(const D3DXVECTOR2 *)((const char *)in + instride * i);
+        D3DXVECTOR2 *o = (D3DXVECTOR2 *)((char *)out + outstride * i);
+
+        norm = m.m[0][3] * v.x + m.m[1][3] * v.y + m.m[3][3];
+        o->x = (m.m[0][0] * v.x + m.m[1][0] * v.y + m.m[3][0]) / norm;
+        o->y = (m.m[0][1] * v.x + m.m[1][1] * v.y + m.m[3][1]) / norm;
     }
     return out;
 }
@@ -1750,15 +1782,22 @@ D3DXVECTOR2* WINAPI D3DXVec2TransformNormal(D3DXVECTOR2 *pout, const D3DXVECTOR2
 
 D3DXVECTOR2* WINAPI D3DXVec2TransformNormalArray(D3DXVECTOR2* out, UINT outstride, const D3DXVECTOR2 *in, UINT instride, const D3DXMATRIX *matrix, UINT elements)
 {
+    D3DXMATRIX m;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec2TransformNormal(
-            (D3DXVECTOR2*)((char*)out + outstride * i),
-            (const D3DXVECTOR2*)((const char*)in + instride * i),
-            matrix);
+    if (!elements)
+        return out;
+    m = *matrix;
+
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR2 v = *(const D3DXVECTOR2 *)((const char *)in + instride * i);
+        D3DXVECTOR2 *o = (D3DXVECTOR2 *)((char *)out + outstride * i);
+
+        o->x = m.m[0][0] * v.x + m.m[1][0] * v.y;
+        o->y = m.m[0][1] * v.x + m.m[1][1] * v.y;
     }
     return out;
 }
@@ -1879,15 +1918,24 @@ D3DXVECTOR4* WINAPI D3DXVec3Transform(D3DXVECTOR4 *pout, const D3DXVECTOR3 *pv,
 
 D3DXVECTOR4* WINAPI D3DXVec3TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    D3DXMATRIX m;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3Transform(
-            (D3DXVECTOR4*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+    if (!elements)
+        return out;
+    m = *matrix;
+
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR3 v = *(const D3DXVECTOR3 *)((const char *)in + instride * i);
+        D3DXVECTOR4 *o = (D3DXVECTOR4 *)((char *)out + outstride * i);
+
+        o->x = m.m[0][0] * v.x + m.m[1][0] * v.y + m.m[2][0] * v.z + m.m[3][0];
+        o->y = m.m[0][1] * v.x + m.m[1][1] * v.y + m.m[2][1] * v.z + m.m[3][1];
+        o->z = m.m[0][2] * v.x + m.m[1][2] * v.y + m.m[2][2] * v.z + m.m[3][2];
+        o->w = m.m[0][3] * v.x + m.m[1][3] * v.y + m.m[2][3] * v.z + m.m[3][3];
     }
     return out;
 }
@@ -1912,15 +1960,25 @@ D3DXVECTOR3* WINAPI D3DXVec3TransformCoord(D3DXVECTOR3 *pout, const D3DXVECTOR3
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformCoordArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    D3DXMATRIX m;
+    FLOAT norm;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformCoord(
-            (D3DXVECTOR3*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+    if (!elements)
+        return out;
+    m = *matrix;
+
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR3 v = *(const D3DXVECTOR3 *)((const char *)in + instride * i);
+        D3DXVECTOR3 *o = (D3DXVECTOR3 *)((char *)out + outstride * i);
+
+        norm = m.m[0][3] * v.x + m.m[1][3] * v.y + m.m[2][3] * v.z + m.m[3][3];
+        o->x = (m.m[0][0] * v.x + m.m[1][0] * v.y + m.m[2][0] * v.z + m.m[3][0]) / norm;
+        o->y = (m.m[0][1] * v.x + m.m[1][1] * v.y + m.m[2][1] * v.z + m.m[3][1]) / norm;
+        o->z = (m.m[0][2] * v.x + m.m[1][2] * v.y + m.m[2][2] * v.z + m.m[3][2]) / norm;
     }
     return out;
 }
@@ -1940,15 +1998,23 @@ D3DXVECTOR3* WINAPI D3DXVec3TransformNormal(D3DXVECTOR3 *pout, const D3DXVECTOR3
 
 D3DXVECTOR3* WINAPI D3DXVec3TransformNormalArray(D3DXVECTOR3* out, UINT outstride, const D3DXVECTOR3* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    D3DXMATRIX m;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec3TransformNormal(
-            (D3DXVECTOR3*)((char*)out + outstride * i),
-            (const D3DXVECTOR3*)((const char*)in + instride * i),
-            matrix);
+    if (!elements)
+        return out;
+    m = *matrix;
+
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR3 v = *(const D3DXVECTOR3 *)((const char *)in + instride * i);
+        D3DXVECTOR3 *o = (D3DXVECTOR3 *)((char *)out + outstride * i);
+
+        o->x = m.m[0][0] * v.x + m.m[1][0] * v.y + m.m[2][0] * v.z;
+        o->y = m.m[0][1] * v.x + m.m[1][1] * v.y + m.m[2][1] * v.z;
+        o->z = m.m[0][2] * v.x + m.m[1][2] * v.y + m.m[2][2] * v.z;
     }
     return out;
 }
@@ -2086,15 +2152,24 @@ D3DXVECTOR4* WINAPI D3DXVec4Transform(D3DXVECTOR4 *pout, const D3DXVECTOR4 *pv,
 
 D3DXVECTOR4* WINAPI D3DXVec4TransformArray(D3DXVECTOR4* out, UINT outstride, const D3DXVECTOR4* in, UINT instride, const D3DXMATRIX* matrix, UINT elements)
 {
+    D3DXMATRIX m;
     UINT i;
 
     TRACE("out %p, outstride %u, in %p, instride %u, matrix %p, elements %u\n", out, outstride, in, instride, matrix, elements);
 
-    for (i = 0; i < elements; ++i) {
-        D3DXVec4Transform(
-            (D3DXVECTOR4*)((char*)out + outstride * i),
-            (const D3DXVECTOR4*)((const char*)in + instride * i),
-            matrix);
+    if (!elements)
+        return out;
+    m = *matrix;
+
+    for (i = 0; i < elements; ++i)
+    {
+        const D3DXVECTOR4 v = *(const D3DXVECTOR4 *)((const char *)in + instride * i);
+        D3DXVECTOR4 *o = (D3DXVECTOR4 *)((char *)out + outstride * i);
+
+        o->x = m.m[0][0] * v.x + m.m[1][0] * v.y + m.m[2][0] * v.z + m.m[3][0] * v.w;
+        o->y = m.m[0][1] * v.x + m.m[1][1] * v.y + m.m[2][1] * v.z + m.m[3][1] * v.w;
+        o->z = m.m[0][2] * v.x + m.m[1][2] * v.y + m.m[2][2] * v.z + m.m[3][2] * v.w;
+        o->w = m.m[0][3] * v.x + m.m[1][3] * v.y + m.m[2][3] * v.z + m.m[3][3] * v.w;
     }
     return out;
 }
@@ -1636,6 +1636,330 @@ static DWORD adjacency_remap(DWORD *face_remap, DWORD index)
     return face_remap[index];
 }
 
+/* Vertex cache optimization, based on Tom Forsyth's "Linear-Speed Vertex Cache
+ * Optimisation". Faces are added one at a time, picking the face with the best
+ * score among the faces using vertices in a simulated LRU cache. */
+#define VCACHE_SIZE 32
+
+struct vcache_vertex
+{
+    int cache_pos;
+    float score;
+    DWORD active_count;
+    DWORD face_start;
+};
+
+static float vcache_vertex_score(const struct vcache_vertex *vertex)
+{
+    static const float last_face_score = 0.75f;
+    static const float cache_decay_power = 1.5f;
+    static const float valence_boost_scale = 2.0f;
+    static const float valence_boost_power = -0.5f;
+    float score = 0.0f;
+
+    if (!vertex->active_count)
+        return -1.0f;
+
+    if (vertex->cache_pos >= 3)
+        score = powf(1.0f - (vertex->cache_pos - 3) * (1.0f / (VCACHE_SIZE - 3)), cache_decay_power);
+    else if (vertex->cache_pos >= 0)
+        score = last_face_score;
+
+    return score + valence_boost_scale * powf(vertex->active_count, valence_boost_power);
+}
+
+/* Reorders faces[0..count) for the post-transform vertex cache. */
+static HRESULT optimize_faces_vertex_cache(const DWORD *indices, DWORD num_vertices, DWORD *faces, DWORD count)
+{
+    struct vcache_vertex *vertices;
+    DWORD *vertex_faces, *order;
+    float *face_scores;
+    BOOL *face_added;
+    DWORD cache[VCACHE_SIZE + 3], new_cache[VCACHE_SIZE + 3];
+    DWORD cache_size = 0, new_cache_size;
+    DWORD i, j, k, best = 0, next_unadded = 0;
+    float best_score;
+    HRESULT hr = E_OUTOFMEMORY;
+
+    vertices = calloc(num_vertices, sizeof(*vertices));
+    vertex_faces = malloc(count * 3 * sizeof(*vertex_faces));
+    order = malloc(count * sizeof(*order));
+    face_scores = malloc(count * sizeof(*face_scores));
+    face_added = calloc(count, sizeof(*face_added));
+    if (!vertices || !vertex_faces || !order || !face_scores || !face_added)
+        goto done;
+
+    for (i = 0; i < count * 3; ++i)
+        vertices[indices[faces[i / 3] * 3 + i % 3]].active_count++;
+    for (i = 0, j = 0; i < num_vertices; ++i)
+    {
+        vertices[i].face_start = j;
+        j += vertices[i].active_count;
+        vertices[i].active_count = 0;
+        vertices[i].cache_pos = -1;
+    }
+    for (i = 0; i < count * 3; ++i)
+    {
+        struct vcache_vertex *vertex = &vertices[indices[faces[i / 3] * 3 + i % 3]];
+        vertex_faces[vertex->face_start + vertex->active_count++] = i / 3;
+    }
+    for (i = 0; i < num_vertices; ++i)
+        vertices[i].score = vcache_vertex_score(&vertices[i]);
+
+    best_score = -1.0f;
+    for (i = 0; i < count; ++i)
+    {
+        face_scores[i] = 0.0f;
+        for (j = 0; j < 3; ++j)
+            face_scores[i] += vertices[indices[faces[i] * 3 + j]].score;
+        if (face_scores[i] > best_score)
+        {
+            best_score = face_scores[i];
+            best = i;
+        }
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        if (best_score < 0.0f)
+        {
+            /* No face touches the cache, pick the next one in the original order. */
+            while (face_added[next_unadded])
+                ++next_unadded;
+            best = next_unadded;
+        }
+
+        order[i] = faces[best];
+        face_added[best] = TRUE;
+
+        /* Remove the face from its vertices, and put them at the front of the cache. */
+        new_cache_size = 0;
+        for (j = 0; j < 3; ++j)
+        {
+            DWORD v = indices[faces[best] * 3 + j];
+            struct vcache_vertex *vertex = &vertices[v];
+            DWORD *list = &vertex_faces[vertex->face_start];
+
+            for (k = 0; k < vertex->active_count; ++k)
+            {
+                if (list[k] == best)
+                {
+                    list[k] = list[--vertex->active_count];
+                    break;
+                }
+            }
+            for (k = 0; k < new_cache_size; ++k)
+                if (new_cache[k] == v) break;
+            if (k == new_cache_size)
+                new_cache[new_cache_size++] = v;
+        }
+        for (j = 0; j < cache_size; ++j)
+        {
+            for (k = 0; k < new_cache_size; ++k)
+                if (new_cache[k] == cache[j]) break;
+            if (k == new_cache_size)
+                new_cache[new_cache_size++] = cache[j];
+        }
+
+        /* Update scores of the vertices in the cache, including those dropped out of it. */
+        for (j = 0; j < new_cache_size; ++j)
+        {
+            struct vcache_vertex *vertex = &vertices[new_cache[j]];
+
+            vertex->cache_pos = j < VCACHE_SIZE ? j : -1;
+            vertex->score = vcache_vertex_score(vertex);
+        }
+        cache_size = min(new_cache_size, VCACHE_SIZE);
+        memcpy(cache, new_cache, cache_size * sizeof(*cache));
+
+        /* Pick the best face among the ones using cached vertices. */
+        best_score = -1.0f;
+        for (j = 0; j < new_cache_size; ++j)
+        {
+            const struct vcache_vertex *vertex = &vertices[new_cache[j]];
+
+            for (k = 0; k < vertex->active_count; ++k)
+            {
+                DWORD face = vertex_faces[vertex->face_start + k];
+                const DWORD *face_indices = &indices[faces[face] * 3];
+
+                face_scores[face] = vertices[face_indices[0]].score + vertices[face_indices[1]].score
+                        + vertices[face_indices[2]].score;
+                if (face_scores[face] > best_score)
+                {
+                    best_score = face_scores[face];
+                    best = face;
+                }
+            }
+        }
+    }
+
+    memcpy(faces, order, count * sizeof(*faces));
+    hr = D3D_OK;
+
+done:
+    free(vertices);
+    free(vertex_faces);
+    free(order);
+    free(face_scores);
+    free(face_added);
+    return hr;
+}
+
+/* Reorders faces[0..count) so that consecutive faces share edges, walking the
+ * adjacency information. Only faces belonging to the same range are followed. */
+static HRESULT optimize_faces_strip_order(const DWORD *adjacency, DWORD num_faces, DWORD *faces, DWORD count)
+{
+    DWORD *range_pos, *order;
+    BOOL *face_added;
+    DWORD i, j, face, next, out = 0;
+    HRESULT hr = E_OUTOFMEMORY;
+
+    range_pos = malloc(num_faces * sizeof(*range_pos));
+    order = malloc(count * sizeof(*order));
+    face_added = calloc(count, sizeof(*face_added));
+    if (!range_pos || !order || !face_added)
+        goto done;
+
+    for (i = 0; i < num_faces; ++i)
+        range_pos[i] = ~0u;
+    for (i = 0; i < count; ++i)
+        range_pos[faces[i]] = i;
+
+    for (i = 0; i < count; ++i)
+    {
+        if (face_added[i])
+            continue;
+
+        for (face = i; face != ~0u; face = next)
+        {
+            DWORD best_neighbours = ~0u;
+
+            order[out++] = faces[face];
+            face_added[face] = TRUE;
+
+            /* Continue with the neighbour that has the fewest remaining
+             * neighbours, to avoid leaving isolated faces behind. */
+            next = ~0u;
+            for (j = 0; j < 3; ++j)
+            {
+                DWORD neighbour = adjacency[faces[face] * 3 + j], k, neighbours = 0;
+
+                if (neighbour >= num_faces || (neighbour = range_pos[neighbour]) == ~0u || face_added[neighbour])
+                    continue;
+                for (k = 0; k < 3; ++k)
+                {
+                    DWORD n = adjacency[faces[neighbour] * 3 + k];
+
+                    if (n < num_faces && range_pos[n] != ~0u && !face_added[range_pos[n]])
+                        ++neighbours;
+                }
+                if (neighbours < best_neighbours)
+                {
+                    best_neighbours = neighbours;
+                    next = neighbour;
+                }
+            }
+        }
+    }
+
+    memcpy(faces, order, count * sizeof(*faces));
+    hr = D3D_OK;
+
+done:
+    free(range_pos);
+    free(order);
+    free(face_added);
+    return hr;
+}
+
+/* Reorders the faces within each attribute range of an attribute sorted face_remap. */
+static HRESULT remap_faces_for_vertex_cache(struct d3dx9_mesh *This, DWORD flags, const DWORD *indices,
+        const DWORD *adjacency, const DWORD *sorted_attrib_buffer, DWORD *face_remap)
+{
+    DWORD *faces, start, end, i;
+    HRESULT hr = D3D_OK;
+
+    if (!(faces = malloc(This->numfaces * sizeof(*faces))))
+        return E_OUTOFMEMORY;
+    for (i = 0; i < This->numfaces; ++i)
+        faces[face_remap[i]] = i;
+
+    for (start = 0; start < This->numfaces && SUCCEEDED(hr); start = end)
+    {
+        for (end = start + 1; end < This->numfaces; ++end)
+            if (sorted_attrib_buffer[end] != sorted_attrib_buffer[start]) break;
+
+        if (flags & D3DXMESHOPT_VERTEXCACHE)
+            hr = optimize_faces_vertex_cache(indices, This->numvertices, faces + start, end - start);
+        else
+            hr = optimize_faces_strip_order(adjacency, This->numfaces, faces + start, end - start);
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        for (i = 0; i < This->numfaces; ++i)
+            face_remap[faces[i]] = i;
+    }
+
+    free(faces);
+    return hr;
+}
+
+/* Creates a vertex_remap that orders vertices by first use in the reordered faces,
+ * removing unused vertices. Indices are updated according to the vertex_remap. */
+static HRESULT remap_vertices_for_face_order(struct d3dx9_mesh *This, DWORD *indices, const DWORD *face_remap,
+        DWORD *new_num_vertices, ID3DXBuffer **vertex_remap)
+{
+    DWORD *vertex_remap_ptr, *faces, *old_to_new;
+    DWORD num_used_vertices = 0;
+    DWORD i, j;
+    HRESULT hr;
+
+    faces = malloc(This->numfaces * sizeof(*faces));
+    old_to_new = malloc(This->numvertices * sizeof(*old_to_new));
+    if (!faces || !old_to_new)
+    {
+        hr = E_OUTOFMEMORY;
+        goto done;
+    }
+
+    hr = D3DXCreateBuffer(This->numvertices * sizeof(DWORD), vertex_remap);
+    if (FAILED(hr)) goto done;
+    vertex_remap_ptr = ID3DXBuffer_GetBufferPointer(*vertex_remap);
+
+    for (i = 0; i < This->numfaces; ++i)
+        faces[face_remap[i]] = i;
+    for (i = 0; i < This->numvertices; ++i)
+        old_to_new[i] = ~0u;
+
+    for (i = 0; i < This->numfaces; ++i)
+    {
+        for (j = 0; j < 3; ++j)
+        {
+            DWORD vertex = indices[faces[i] * 3 + j];
+
+            if (old_to_new[vertex] == ~0u)
+            {
+                vertex_remap_ptr[num_used_vertices] = vertex;
+                old_to_new[vertex] = num_used_vertices++;
+            }
+        }
+    }
+    for (i = num_used_vertices; i < This->numvertices; ++i)
+        vertex_remap_ptr[i] = -1;
+
+    for (i = 0; i < This->numfaces * 3; ++i)
+        indices[i] = old_to_new[indices[i]];
+
+    *new_num_vertices = num_used_vertices;
+
+done:
+    free(faces);
+    free(old_to_new);
+    return hr;
+}
+
 static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags, const DWORD *adjacency_in,
         DWORD *adjacency_out, DWORD *face_remap_out, ID3DXBuffer **vertex_remap_out)
 {
@@ -1662,15 +1986,6 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
     if ((flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER)) == (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
         return D3DERR_INVALIDCALL;
 
-    if (flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
-    {
-        if (flags & D3DXMESHOPT_VERTEXCACHE)
-            FIXME("D3DXMESHOPT_VERTEXCACHE not implemented.\n");
-        if (flags & D3DXMESHOPT_STRIPREORDER)
-            FIXME("D3DXMESHOPT_STRIPREORDER not implemented.\n");
-        return E_NOTIMPL;
-    }
-
     hr = iface->lpVtbl->LockIndexBuffer(iface, 0, &indices);
     if (FAILED(hr)) goto cleanup;
 
@@ -1684,7 +1999,26 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
             dword_indices[i] = *word_indices++;
     }
 
-    if ((flags & (D3DXMESHOPT_COMPACT | D3DXMESHOPT_IGNOREVERTS | D3DXMESHOPT_ATTRSORT)) == D3DXMESHOPT_COMPACT)
+    if (flags & (D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER))
+    {
+        /* Face reordering is done within attribute ranges, which implies sorting by attribute. */
+        hr = iface->lpVtbl->LockAttributeBuffer(iface, 0, &attrib_buffer);
+        if (FAILED(hr)) goto cleanup;
+
+        hr = remap_faces_for_attrsort(This, dword_indices, attrib_buffer, &sorted_attrib_buffer, &face_remap);
+        if (FAILED(hr)) goto cleanup;
+
+        hr = remap_faces_for_vertex_cache(This, flags, dword_indices, adjacency_in, sorted_attrib_buffer, face_remap);
+        if (FAILED(hr)) goto cleanup;
+
+        if (!(flags & D3DXMESHOPT_IGNOREVERTS))
+        {
+            new_num_alloc_vertices = This->numvertices;
+            hr = remap_vertices_for_face_order(This, dword_indices, face_remap, &new_num_vertices, &vertex_remap);
+            if (FAILED(hr)) goto cleanup;
+        }
+    }
+    else if ((flags & (D3DXMESHOPT_COMPACT | D3DXMESHOPT_IGNOREVERTS | D3DXMESHOPT_ATTRSORT)) == D3DXMESHOPT_COMPACT)
     {
         new_num_alloc_vertices = This->numvertices;
         hr = compact_mesh(This, dword_indices, &new_num_vertices, &vertex_remap);
@@ -1740,7 +2074,7 @@ static HRESULT WINAPI d3dx9_mesh_OptimizeInplace(ID3DXMesh *iface, DWORD flags,
             *vertex_remap_ptr++ = i;
     }
 
-    if (flags & D3DXMESHOPT_ATTRSORT)
+    if (sorted_attrib_buffer)
     {
         D3DXATTRIBUTERANGE *attrib_table;
         DWORD attrib_table_size;
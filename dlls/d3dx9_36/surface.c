@@ -1481,6 +1481,7 @@ struct argb_conversion_info
     DWORD srcmask[4], destmask[4];
     BOOL process_channel[4];
     DWORD channelmask;
+    BOOL byte_channels;
 };
 
 static void init_argb_conversion_info(const struct pixel_format_desc *srcformat, const struct pixel_format_desc *destformat, struct argb_conversion_info *info)
@@ -1488,6 +1489,7 @@ static void init_argb_conversion_info(const struct pixel_format_desc *srcformat,
     UINT i;
     ZeroMemory(info->process_channel, 4 * sizeof(BOOL));
     info->channelmask = 0;
+    info->byte_channels = srcformat->bytes_per_pixel <= 4 && destformat->bytes_per_pixel <= 4;
 
     info->srcformat  =  srcformat;
     info->destformat = destformat;
@@ -1507,6 +1509,11 @@ static void init_argb_conversion_info(const struct pixel_format_desc *srcformat,
             if(srcformat->bits[i]) info->process_channel[i] = TRUE;
             else info->channelmask |= info->destmask[i];
         }
+
+        /* byte_channels specifies that every converted channel is a whole byte in both formats */
+        if (info->process_channel[i] && (srcformat->bits[i] != 8 || destformat->bits[i] != 8
+                || srcformat->shift[i] % 8 || destformat->shift[i] % 8))
+            info->byte_channels = FALSE;
     }
 }
 
@@ -1563,6 +1570,35 @@ static DWORD make_argb_color(const struct argb_conversion_info *info, const DWOR
     return val;
 }
 
+/************************************************************
+ * make_argb_color_from_bytes
+ *
+ * Equivalent to get_relevant_argb_components followed by make_argb_color,
+ * for conversions where all the channels are 8 bits wide and byte aligned.
+ */
+static DWORD make_argb_color_from_bytes(const struct argb_conversion_info *info, const BYTE *col)
+{
+    DWORD in = 0, val = info->channelmask;
+    UINT i;
+
+    memcpy(&in, col, info->srcformat->bytes_per_pixel);
+    for (i = 0; i < 4; ++i)
+    {
+        if (info->process_channel[i])
+            val |= ((in >> info->srcformat->shift[i]) & 0xff) << info->destformat->shift[i];
+    }
+    return val;
+}
+
+static DWORD convert_argb_color(const struct argb_conversion_info *info, const BYTE *col, DWORD *channels)
+{
+    if (info->byte_channels)
+        return make_argb_color_from_bytes(info, col);
+
+    get_relevant_argb_components(info, col, channels);
+    return make_argb_color(info, channels);
+}
+
 /* It doesn't work for components bigger than 32 bits (or somewhat smaller but unaligned). */
 void format_to_vec4(const struct pixel_format_desc *format, const BYTE *src, struct vec4 *dst)
 {
@@ -1684,6 +1720,7 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
     const struct pixel_format_desc *ck_format = NULL;
     DWORD channels[4];
     UINT min_width, min_height, min_depth;
+    BOOL integer_conversion, copy_rows;
     UINT x, y, z;
 
     TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
@@ -1705,6 +1742,15 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
         init_argb_conversion_info(src_format, ck_format, &ck_conv_info);
     }
 
+    integer_conversion = !src_format->to_rgba && !dst_format->from_rgba
+            && src_format->type == dst_format->type
+            && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4;
+    /* Without a color key, converting to the same format is a plain copy,
+     * as long as there are no unused bits which would get cleared. */
+    copy_rows = !color_key && src_format == dst_format && integer_conversion
+            && src_format->bits[0] + src_format->bits[1] + src_format->bits[2] + src_format->bits[3]
+            == src_format->bytes_per_pixel * 8;
+
     for (z = 0; z < min_depth; z++) {
         const BYTE *src_slice_ptr = src + z * src_slice_pitch;
         BYTE *dst_slice_ptr = dst + z * dst_slice_pitch;
@@ -1713,56 +1759,52 @@ void convert_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pit
             const BYTE *src_ptr = src_slice_ptr + y * src_row_pitch;
             BYTE *dst_ptr = dst_slice_ptr + y * dst_row_pitch;
 
-            for (x = 0; x < min_width; x++) {
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->type == dst_format->type
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
-                {
-                    DWORD val;
-
-                    get_relevant_argb_components(&conv_info, src_ptr, channels);
-                    val = make_argb_color(&conv_info, channels);
-
-                    if (color_key)
+            if (copy_rows)
+            {
+                memcpy(dst_ptr, src_ptr, min_width * src_format->bytes_per_pixel);
+                dst_ptr += min_width * dst_format->bytes_per_pixel;
+            }
+            else
+            {
+                for (x = 0; x < min_width; x++) {
+                    if (integer_conversion)
                     {
-                        DWORD ck_pixel;
+                        DWORD val = convert_argb_color(&conv_info, src_ptr, channels);
 
-                        get_relevant_argb_components(&ck_conv_info, src_ptr, channels);
-                        ck_pixel = make_argb_color(&ck_conv_info, channels);
-                        if (ck_pixel == color_key)
+                        if (color_key && convert_argb_color(&ck_conv_info, src_ptr, channels) == color_key)
                             val &= ~conv_info.destmask[0];
+                        memcpy(dst_ptr, &val, dst_format->bytes_per_pixel);
                     }
-                    memcpy(dst_ptr, &val, dst_format->bytes_per_pixel);
-                }
-                else
-                {
-                    struct vec4 color, tmp;
-
-                    format_to_vec4(src_format, src_ptr, &color);
-                    if (src_format->to_rgba)
-                        src_format->to_rgba(&color, &tmp, palette);
                     else
-                        tmp = color;
-
-                    if (ck_format)
                     {
-                        DWORD ck_pixel;
+                        struct vec4 color, tmp;
 
-                        format_from_vec4(ck_format, &tmp, (BYTE *)&ck_pixel);
-                        if (ck_pixel == color_key)
-                            tmp.w = 0.0f;
-                    }
+                        format_to_vec4(src_format, src_ptr, &color);
+                        if (src_format->to_rgba)
+                            src_format->to_rgba(&color, &tmp, palette);
+                        else
+                            tmp = color;
 
-                    if (dst_format->from_rgba)
-                        dst_format->from_rgba(&tmp, &color);
-                    else
-                        color = tmp;
+                        if (ck_format)
+                        {
+                            DWORD ck_pixel;
 
-                    format_from_vec4(dst_format, &color, dst_ptr);
-                }
+                            format_from_vec4(ck_format, &tmp, (BYTE *)&ck_pixel);
+                            if (ck_pixel == color_key)
+                                tmp.w = 0.0f;
+                        }
 
-                src_ptr += src_format->bytes_per_pixel;
-                dst_ptr += dst_format->bytes_per_pixel;
+                        if (dst_format->from_rgba)
+                            dst_format->from_rgba(&tmp, &color);
+                        else
+                            color = tmp;
+
+                        format_from_vec4(dst_format, &color, dst_ptr);
+                    }
+
+                    src_ptr += src_format->bytes_per_pixel;
+                    dst_ptr += dst_format->bytes_per_pixel;
+                }
             }
 
             if (src_size->width < dst_size->width) /* black out remaining pixels */
@@ -1790,6 +1832,7 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
 {
     struct argb_conversion_info conv_info, ck_conv_info;
     const struct pixel_format_desc *ck_format = NULL;
+    BOOL integer_conversion;
     DWORD channels[4];
     UINT x, y, z;
 
@@ -1808,6 +1851,10 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
         init_argb_conversion_info(src_format, ck_format, &ck_conv_info);
     }
 
+    integer_conversion = !src_format->to_rgba && !dst_format->from_rgba
+            && src_format->type == dst_format->type
+            && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4;
+
     for (z = 0; z < dst_size->depth; z++)
     {
         BYTE *dst_slice_ptr = dst + z * dst_slice_pitch;
@@ -1822,24 +1869,12 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
             {
                 const BYTE *src_ptr = src_row_ptr + (x * src_size->width / dst_size->width) * src_format->bytes_per_pixel;
 
-                if (!src_format->to_rgba && !dst_format->from_rgba
-                        && src_format->type == dst_format->type
-                        && src_format->bytes_per_pixel <= 4 && dst_format->bytes_per_pixel <= 4)
+                if (integer_conversion)
                 {
-                    DWORD val;
+                    DWORD val = convert_argb_color(&conv_info, src_ptr, channels);
 
-                    get_relevant_argb_components(&conv_info, src_ptr, channels);
-                    val = make_argb_color(&conv_info, channels);
-
-                    if (color_key)
-                    {
-                        DWORD ck_pixel;
-
-                        get_relevant_argb_components(&ck_conv_info, src_ptr, channels);
-                        ck_pixel = make_argb_color(&ck_conv_info, channels);
-                        if (ck_pixel == color_key)
-                            val &= ~conv_info.destmask[0];
-                    }
+                    if (color_key && convert_argb_color(&ck_conv_info, src_ptr, channels) == color_key)
+                        val &= ~conv_info.destmask[0];
                     memcpy(dst_ptr, &val, dst_format->bytes_per_pixel);
                 }
                 else
@@ -1875,6 +1910,144 @@ void point_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slic
     }
 }
 
+/************************************************************
+ * box_filter_argb_pixels
+ *
+ * Copies the source buffer to the destination buffer, performing
+ * any necessary format conversion and color keying, and averaging
+ * the source pixels covered by each destination pixel. When
+ * magnifying, this is equivalent to a point filter.
+ */
+void box_filter_argb_pixels(const BYTE *src, UINT src_row_pitch, UINT src_slice_pitch, const struct volume *src_size,
+        const struct pixel_format_desc *src_format, BYTE *dst, UINT dst_row_pitch, UINT dst_slice_pitch,
+        const struct volume *dst_size, const struct pixel_format_desc *dst_format, D3DCOLOR color_key,
+        const PALETTEENTRY *palette)
+{
+    struct argb_conversion_info conv_info;
+    const struct pixel_format_desc *ck_format = NULL;
+    UINT x, y, z, i, j, k, c;
+    BOOL average_bytes;
+
+    TRACE("src %p, src_row_pitch %u, src_slice_pitch %u, src_size %p, src_format %p, dst %p, "
+            "dst_row_pitch %u, dst_slice_pitch %u, dst_size %p, dst_format %p, color_key 0x%08lx, palette %p.\n",
+            src, src_row_pitch, src_slice_pitch, src_size, src_format, dst, dst_row_pitch, dst_slice_pitch, dst_size,
+            dst_format, color_key, palette);
+
+    init_argb_conversion_info(src_format, dst_format, &conv_info);
+
+    /* Color keys are always represented in D3DFMT_A8R8G8B8 format. */
+    if (color_key)
+        ck_format = get_format_info(D3DFMT_A8R8G8B8);
+
+    /* Plain 8 bits per channel formats can be averaged directly. */
+    average_bytes = !color_key && !src_format->to_rgba && !dst_format->from_rgba
+            && src_format->type == FORMAT_ARGB && dst_format->type == FORMAT_ARGB && conv_info.byte_channels;
+
+    for (z = 0; z < dst_size->depth; ++z)
+    {
+        const UINT z0 = z * src_size->depth / dst_size->depth;
+        const UINT z1 = max((z + 1) * src_size->depth / dst_size->depth, z0 + 1);
+        BYTE *dst_slice_ptr = dst + z * dst_slice_pitch;
+
+        for (y = 0; y < dst_size->height; ++y)
+        {
+            const UINT y0 = y * src_size->height / dst_size->height;
+            const UINT y1 = max((y + 1) * src_size->height / dst_size->height, y0 + 1);
+            BYTE *dst_ptr = dst_slice_ptr + y * dst_row_pitch;
+
+            for (x = 0; x < dst_size->width; ++x)
+            {
+                const UINT x0 = x * src_size->width / dst_size->width;
+                const UINT x1 = max((x + 1) * src_size->width / dst_size->width, x0 + 1);
+                const UINT count = (x1 - x0) * (y1 - y0) * (z1 - z0);
+
+                if (average_bytes)
+                {
+                    UINT64 sums[4] = {0};
+                    DWORD in, val = 0;
+
+                    for (k = z0; k < z1; ++k)
+                    {
+                        for (j = y0; j < y1; ++j)
+                        {
+                            const BYTE *src_ptr = src + k * src_slice_pitch + j * src_row_pitch
+                                    + x0 * src_format->bytes_per_pixel;
+
+                            for (i = x0; i < x1; ++i)
+                            {
+                                in = 0;
+                                memcpy(&in, src_ptr, src_format->bytes_per_pixel);
+                                for (c = 0; c < 4; ++c)
+                                    sums[c] += (in >> src_format->shift[c]) & 0xff;
+                                src_ptr += src_format->bytes_per_pixel;
+                            }
+                        }
+                    }
+
+                    for (c = 0; c < 4; ++c)
+                    {
+                        if (conv_info.process_channel[c])
+                            val |= (DWORD)((sums[c] + count / 2) / count) << src_format->shift[c];
+                    }
+                    val = make_argb_color_from_bytes(&conv_info, (const BYTE *)&val);
+                    memcpy(dst_ptr, &val, dst_format->bytes_per_pixel);
+                }
+                else
+                {
+                    struct vec4 color, tmp, sum = {0.0f, 0.0f, 0.0f, 0.0f};
+
+                    for (k = z0; k < z1; ++k)
+                    {
+                        for (j = y0; j < y1; ++j)
+                        {
+                            const BYTE *src_ptr = src + k * src_slice_pitch + j * src_row_pitch
+                                    + x0 * src_format->bytes_per_pixel;
+
+                            for (i = x0; i < x1; ++i)
+                            {
+                                format_to_vec4(src_format, src_ptr, &color);
+                                if (src_format->to_rgba)
+                                    src_format->to_rgba(&color, &tmp, palette);
+                                else
+                                    tmp = color;
+
+                                if (ck_format)
+                                {
+                                    DWORD ck_pixel;
+
+                                    format_from_vec4(ck_format, &tmp, (BYTE *)&ck_pixel);
+                                    if (ck_pixel == color_key)
+                                        tmp.w = 0.0f;
+                                }
+
+                                sum.x += tmp.x;
+                                sum.y += tmp.y;
+                                sum.z += tmp.z;
+                                sum.w += tmp.w;
+                                src_ptr += src_format->bytes_per_pixel;
+                            }
+                        }
+                    }
+
+                    tmp.x = sum.x / count;
+                    tmp.y = sum.y / count;
+                    tmp.z = sum.z / count;
+                    tmp.w = sum.w / count;
+
+                    if (dst_format->from_rgba)
+                        dst_format->from_rgba(&tmp, &color);
+                    else
+                        color = tmp;
+
+                    format_from_vec4(dst_format, &color, dst_ptr);
+                }
+
+                dst_ptr += dst_format->bytes_per_pixel;
+            }
+        }
+    }
+}
+
 /************************************************************
  * D3DXLoadSurfaceFromMemory
  *
@@ -2113,13 +2286,18 @@ HRESULT WINAPI D3DXLoadSurfaceFromMemory(IDirect3DSurface9 *dst_surface,
             convert_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
                     dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
         }
+        else if ((filter & 0xf) == D3DX_FILTER_BOX)
+        {
+            box_filter_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
+                    dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
+        }
         else /* if ((filter & 0xf) == D3DX_FILTER_POINT) */
         {
             if ((filter & 0xf) != D3DX_FILTER_POINT)
                 FIXME("Unhandled filter %#lx.\n", filter);
 
-            /* Always apply a point filter until D3DX_FILTER_LINEAR,
-             * D3DX_FILTER_TRIANGLE and D3DX_FILTER_BOX are implemented. */
+            /* Always apply a point filter until D3DX_FILTER_LINEAR
+             * and D3DX_FILTER_TRIANGLE are implemented. */
             point_filter_argb_pixels(src_memory, src_pitch, 0, &src_size, srcformatdesc,
                     dst_mem, dst_pitch, 0, &dst_size, dst_format, color_key, src_palette);
         }
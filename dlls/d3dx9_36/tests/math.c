@@ -3250,6 +3250,14 @@ static void test_D3DXVec_Array(void)
         if (!equal)
             break;
     }
+
+    /* The matrix is not accessed when there are no elements. */
+    ok(D3DXVec3TransformArray(out_vec, sizeof(*out_vec), (D3DXVECTOR3 *)inp_vec,
+            sizeof(*inp_vec), NULL, 0) == out_vec, "Got unexpected return value.\n");
+    ok(D3DXVec4TransformArray(out_vec, sizeof(*out_vec), inp_vec,
+            sizeof(*inp_vec), NULL, 0) == out_vec, "Got unexpected return value.\n");
+    ok(D3DXPlaneTransformArray(out_plane, sizeof(*out_plane), inp_plane,
+            sizeof(*inp_plane), NULL, 0) == out_plane, "Got unexpected return value.\n");
 }
 
 static void test_D3DXFloat_Array(void)
@@ -11794,6 +11794,133 @@ static void test_mesh_optimize(void)
     ok(!memcmp(adjacency_out, expected_adjacency_out, sizeof(adjacency)), "data mismatch.\n");
 
     buffer->lpVtbl->Release(buffer);
+
+    hr = mesh->lpVtbl->OptimizeInplace(mesh, D3DXMESHOPT_VERTEXCACHE | D3DXMESHOPT_STRIPREORDER,
+            adjacency_out, NULL, NULL, NULL);
+    ok(hr == D3DERR_INVALIDCALL, "got %#lx.\n", hr);
+    hr = mesh->lpVtbl->OptimizeInplace(mesh, D3DXMESHOPT_VERTEXCACHE, NULL, NULL, NULL, NULL);
+    ok(hr == D3DERR_INVALIDCALL, "got %#lx.\n", hr);
+
+    for (i = 0; i < 2; ++i)
+    {
+        DWORD flags = i ? D3DXMESHOPT_STRIPREORDER : D3DXMESHOPT_VERTEXCACHE;
+        unsigned short old_indices[ARRAY_SIZE(indices)];
+        const unsigned short *new_indices;
+        DWORD face_remap[ARRAY_SIZE(attrs)];
+        const DWORD *new_attrs;
+        unsigned int j, k;
+
+        hr = mesh->lpVtbl->LockIndexBuffer(mesh, 0, &data);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+        memcpy(old_indices, data, sizeof(old_indices));
+        hr = mesh->lpVtbl->UnlockIndexBuffer(mesh);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+        memcpy(adjacency, adjacency_out, sizeof(adjacency));
+
+        hr = mesh->lpVtbl->OptimizeInplace(mesh, flags | D3DXMESHOPT_IGNOREVERTS, adjacency, adjacency_out,
+                face_remap, NULL);
+        ok(hr == S_OK, "flags %#lx, got %#lx.\n", flags, hr);
+
+        hr = mesh->lpVtbl->LockIndexBuffer(mesh, D3DLOCK_READONLY, &data);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+        new_indices = data;
+        for (j = 0; j < ARRAY_SIZE(attrs); ++j)
+        {
+            const unsigned short *old_face = &old_indices[face_remap[j] * 3];
+
+            ok(face_remap[j] < ARRAY_SIZE(attrs), "flags %#lx, face %u, got remap %lu.\n", flags, j, face_remap[j]);
+            for (k = 0; k < 3; ++k)
+                if (new_indices[j * 3] == old_face[k]
+                        && new_indices[j * 3 + 1] == old_face[(k + 1) % 3]
+                        && new_indices[j * 3 + 2] == old_face[(k + 2) % 3])
+                    break;
+            ok(k < 3, "flags %#lx, face %u doesn't match face %lu.\n", flags, j, face_remap[j]);
+        }
+        hr = mesh->lpVtbl->UnlockIndexBuffer(mesh);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+
+        hr = mesh->lpVtbl->LockAttributeBuffer(mesh, D3DLOCK_READONLY, (DWORD **)&data);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+        new_attrs = data;
+        for (j = 1; j < ARRAY_SIZE(attrs); ++j)
+            ok(new_attrs[j - 1] <= new_attrs[j], "flags %#lx, attributes are not sorted.\n", flags);
+        hr = mesh->lpVtbl->UnlockAttributeBuffer(mesh);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+    }
+
+    /* Without D3DXMESHOPT_IGNOREVERTS the vertices are reordered too. The
+     * vertex buffer is still in its original order at this point. */
+    {
+        unsigned short old_indices[ARRAY_SIZE(indices)];
+        const unsigned short *new_indices;
+        DWORD face_remap[ARRAY_SIZE(attrs)];
+        BOOL used[ARRAY_SIZE(vertices)] = {0};
+        const DWORD *vertex_remap;
+        unsigned int j, k;
+        BOOL valid;
+
+        hr = mesh->lpVtbl->LockIndexBuffer(mesh, 0, &data);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+        memcpy(old_indices, data, sizeof(old_indices));
+        hr = mesh->lpVtbl->UnlockIndexBuffer(mesh);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+        memcpy(adjacency, adjacency_out, sizeof(adjacency));
+
+        hr = mesh->lpVtbl->OptimizeInplace(mesh, D3DXMESHOPT_VERTEXCACHE, adjacency, adjacency_out,
+                face_remap, &buffer);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+        ok(mesh->lpVtbl->GetNumVertices(mesh) == ARRAY_SIZE(vertices), "got %lu.\n",
+                mesh->lpVtbl->GetNumVertices(mesh));
+
+        size = buffer->lpVtbl->GetBufferSize(buffer);
+        ok(size == sizeof(DWORD) * ARRAY_SIZE(vertices), "got %lu.\n", size);
+        vertex_remap = buffer->lpVtbl->GetBufferPointer(buffer);
+        for (i = 0; i < ARRAY_SIZE(vertices); ++i)
+        {
+            ok(vertex_remap[i] < ARRAY_SIZE(vertices) && !used[vertex_remap[i]],
+                    "i %u, got %lu.\n", i, vertex_remap[i]);
+            if (vertex_remap[i] < ARRAY_SIZE(vertices))
+                used[vertex_remap[i]] = TRUE;
+        }
+
+        hr = mesh->lpVtbl->LockVertexBuffer(mesh, D3DLOCK_READONLY, &data);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+        for (i = 0; i < ARRAY_SIZE(vertices); ++i)
+        {
+            if (vertex_remap[i] < ARRAY_SIZE(vertices))
+                ok(!memcmp((BYTE *)data + i * sizeof(*vertices), &vertices[vertex_remap[i]], sizeof(*vertices)),
+                        "vertex %u doesn't match vertex %lu.\n", i, vertex_remap[i]);
+        }
+        hr = mesh->lpVtbl->UnlockVertexBuffer(mesh);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+
+        hr = mesh->lpVtbl->LockIndexBuffer(mesh, D3DLOCK_READONLY, &data);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+        new_indices = data;
+        for (j = 0; j < ARRAY_SIZE(attrs); ++j)
+        {
+            const unsigned short *old_face = &old_indices[face_remap[j] * 3];
+            const unsigned short *new_face = &new_indices[j * 3];
+
+            ok(face_remap[j] < ARRAY_SIZE(attrs), "face %u, got remap %lu.\n", j, face_remap[j]);
+            valid = new_face[0] < ARRAY_SIZE(vertices) && new_face[1] < ARRAY_SIZE(vertices)
+                    && new_face[2] < ARRAY_SIZE(vertices);
+            ok(valid, "face %u, got indices %u, %u, %u.\n", j, new_face[0], new_face[1], new_face[2]);
+            if (!valid)
+                continue;
+            for (k = 0; k < 3; ++k)
+                if (vertex_remap[new_face[0]] == old_face[k]
+                        && vertex_remap[new_face[1]] == old_face[(k + 1) % 3]
+                        && vertex_remap[new_face[2]] == old_face[(k + 2) % 3])
+                    break;
+            ok(k < 3, "face %u doesn't reference the vertices of face %lu.\n", j, face_remap[j]);
+        }
+        hr = mesh->lpVtbl->UnlockIndexBuffer(mesh);
+        ok(hr == S_OK, "got %#lx.\n", hr);
+
+        buffer->lpVtbl->Release(buffer);
+    }
+
     mesh->lpVtbl->Release(mesh);
     free_test_context(test_context);
 }
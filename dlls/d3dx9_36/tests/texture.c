@@ -912,6 +912,85 @@ static void test_D3DXCreateTexture(IDirect3DDevice9 *device)
     ok(hr == D3DERR_INVALIDCALL, "D3DXCreateTextureFromResourceEx returned %#lx, expected %#lx\n", hr, D3DERR_INVALIDCALL);
 }
 
+static void test_box_filter(IDirect3DDevice9 *device)
+{
+    static const DWORD level0[] =
+    {
+        0x00000000, 0x40404040, 0xff0000ff, 0xff0000ff,
+        0x80808080, 0xc0c0c0c0, 0x01000001, 0x01000001,
+        0x14345878, 0x14345878, 0x10203040, 0x30405060,
+        0x14345878, 0x14345878, 0x10203040, 0x30405060,
+    };
+    static const DWORD level1[] = {0x60606060, 0x80000080, 0x14345878, 0x20304050};
+    /* All reasonable ways to sample this down to one pixel give the same
+     * result. */
+    static const DWORD odd[] =
+    {
+        0x60606060, 0x60606060, 0x20202020,
+        0x60606060, 0x60606060, 0xa0a0a0a0,
+        0x40404040, 0x80808080, 0x60606060,
+    };
+    IDirect3DSurface9 *surface;
+    D3DLOCKED_RECT lock_rect;
+    IDirect3DTexture9 *tex;
+    unsigned int x, y;
+    DWORD color;
+    RECT rect;
+    HRESULT hr;
+
+    hr = IDirect3DDevice9_CreateTexture(device, 4, 4, 3, 0, D3DFMT_A8R8G8B8, D3DPOOL_MANAGED, &tex, NULL);
+    if (FAILED(hr))
+    {
+        skip("Failed to create texture, hr %#lx.\n", hr);
+        return;
+    }
+
+    hr = IDirect3DTexture9_LockRect(tex, 0, &lock_rect, NULL, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+    for (y = 0; y < 4; ++y)
+        memcpy((BYTE *)lock_rect.pBits + y * lock_rect.Pitch, level0 + y * 4, 4 * sizeof(DWORD));
+    hr = IDirect3DTexture9_UnlockRect(tex, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+
+    hr = D3DXFilterTexture((IDirect3DBaseTexture9 *)tex, NULL, 0, D3DX_FILTER_BOX);
+    ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+
+    hr = IDirect3DTexture9_LockRect(tex, 1, &lock_rect, NULL, D3DLOCK_READONLY);
+    ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+    for (y = 0; y < 2; ++y)
+    {
+        for (x = 0; x < 2; ++x)
+        {
+            color = ((DWORD *)((BYTE *)lock_rect.pBits + y * lock_rect.Pitch))[x];
+            ok(color == level1[y * 2 + x], "Got color 0x%08lx at (%u, %u), expected 0x%08lx.\n",
+                    color, x, y, level1[y * 2 + x]);
+        }
+    }
+    IDirect3DTexture9_UnlockRect(tex, 1);
+
+    hr = IDirect3DTexture9_LockRect(tex, 2, &lock_rect, NULL, D3DLOCK_READONLY);
+    ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+    color = *(DWORD *)lock_rect.pBits;
+    ok(color == 0x45313e6a, "Got color 0x%08lx.\n", color);
+    IDirect3DTexture9_UnlockRect(tex, 2);
+
+    IDirect3DTexture9_Release(tex);
+
+    /* Odd source dimensions. */
+    hr = IDirect3DDevice9_CreateOffscreenPlainSurface(device, 1, 1, D3DFMT_A8R8G8B8, D3DPOOL_SYSTEMMEM, &surface, NULL);
+    ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+    SetRect(&rect, 0, 0, 3, 3);
+    hr = D3DXLoadSurfaceFromMemory(surface, NULL, NULL, odd, D3DFMT_A8R8G8B8, 3 * sizeof(DWORD),
+            NULL, &rect, D3DX_FILTER_BOX, 0);
+    ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+    hr = IDirect3DSurface9_LockRect(surface, &lock_rect, NULL, D3DLOCK_READONLY);
+    ok(hr == D3D_OK, "Got unexpected hr %#lx.\n", hr);
+    color = *(DWORD *)lock_rect.pBits;
+    ok(color == 0x60606060, "Got color 0x%08lx.\n", color);
+    IDirect3DSurface9_UnlockRect(surface);
+    IDirect3DSurface9_Release(surface);
+}
+
 static void test_D3DXFilterTexture(IDirect3DDevice9 *device)
 {
     IDirect3DTexture9 *tex;
@@ -2828,6 +2907,7 @@ START_TEST(texture)
     test_D3DXCheckVolumeTextureRequirements(device);
     test_D3DXCreateTexture(device);
     test_D3DXFilterTexture(device);
+    test_box_filter(device);
     test_D3DXFillTexture(device);
     test_D3DXFillCubeTexture(device);
     test_D3DXFillVolumeTexture(device);
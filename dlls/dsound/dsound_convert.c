@@ -99,6 +99,47 @@ static float getieee32(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD chan
 
 const bitsgetfunc getbpp[5] = {get8, get16, get24, get32, getieee32};
 
+static void convert8(const BYTE *src, float *dst, UINT samples)
+{
+    while (samples--)
+        *dst++ = (*src++ - 0x80) / (float)0x80;
+}
+
+static void convert16(const BYTE *src, float *dst, UINT samples)
+{
+    const SHORT *sbuf = (const SHORT *)src;
+
+    while (samples--)
+        *dst++ = (SHORT)le16(*sbuf++) / (float)0x8000;
+}
+
+static void convert24(const BYTE *src, float *dst, UINT samples)
+{
+    LONG sample;
+
+    while (samples--)
+    {
+        sample = (src[0] << 8) | (src[1] << 16) | (src[2] << 24);
+        *dst++ = sample / (float)0x80000000U;
+        src += 3;
+    }
+}
+
+static void convert32(const BYTE *src, float *dst, UINT samples)
+{
+    const LONG *sbuf = (const LONG *)src;
+
+    while (samples--)
+        *dst++ = (LONG)le32(*sbuf++) / (float)0x80000000U;
+}
+
+static void convertieee32(const BYTE *src, float *dst, UINT samples)
+{
+    memcpy(dst, src, samples * sizeof(float));
+}
+
+const bitsconvertfunc convertbpp[5] = {convert8, convert16, convert24, convert32, convertieee32};
+
 float get_mono(const IDirectSoundBufferImpl *dsb, BYTE *base, DWORD channel)
 {
     DWORD channels = dsb->pwfx->nChannels;
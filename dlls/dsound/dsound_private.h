@@ -46,6 +46,8 @@ typedef struct DirectSoundDevice             DirectSoundDevice;
 typedef float (*bitsgetfunc)(const IDirectSoundBufferImpl *, BYTE *, DWORD);
 typedef void (*bitsputfunc)(const IDirectSoundBufferImpl *, DWORD, DWORD, float);
 extern const bitsgetfunc getbpp[5];
+typedef void (*bitsconvertfunc)(const BYTE *, float *, UINT);
+extern const bitsconvertfunc convertbpp[5];
 void putieee32(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value);
 void putieee32_sum(const IDirectSoundBufferImpl *dsb, DWORD pos, DWORD channel, float value);
 void mixieee32(float *src, float *dst, unsigned samples);
@@ -170,6 +172,7 @@ struct IDirectSoundBufferImpl
     int                         mix_channels;
     bitsgetfunc get, get_aux;
     bitsputfunc put, put_aux;
+    bitsconvertfunc             convert; /* set when frames can be converted as a block */
     int                         num_filters;
     DSFilter*                   filters;
 
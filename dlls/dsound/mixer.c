@@ -140,6 +140,7 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 
 	dsb->get = dsb->get_aux;
 	dsb->put = dsb->put_aux;
+	dsb->convert = NULL;
 
 	if (ichannels == ochannels)
 	{
@@ -199,6 +200,10 @@ void DSOUND_RecalcFormat(IDirectSoundBufferImpl *dsb)
 			FIXME("Conversion from %lu to %lu channels is not implemented, falling back to stereo\n", ichannels, ochannels);
 		dsb->mix_channels = 2;
 	}
+
+	/* straight sample format conversion, frames can be converted in blocks */
+	if (ichannels == ochannels && dsb->mix_channels == ichannels && dsb->put == putieee32)
+		dsb->convert = ieee ? convertbpp[4] : convertbpp[dsb->pwfx->wBitsPerSample/8 - 1];
 }
 
 /**
@@ -286,6 +291,40 @@ static inline float get_current_sample(const IDirectSoundBufferImpl *dsb,
     return dsb->get(dsb, buffer + (mixpos % buflen), channel);
 }
 
+/* Convert a block of frames to the float mix format, wrapping around the end of looping buffers */
+static void convert_current_samples(const IDirectSoundBufferImpl *dsb, BYTE *buffer, DWORD buflen,
+        DWORD mixpos, UINT count, float *dst)
+{
+    UINT istride = dsb->pwfx->nBlockAlign;
+    UINT channels = dsb->mix_channels;
+    DWORD pos, channel;
+    UINT frames;
+
+    while (count)
+    {
+        if (mixpos >= buflen && !(dsb->playflags & DSBPLAY_LOOPING))
+        {
+            memset(dst, 0, count * channels * sizeof(float));
+            return;
+        }
+
+        pos = mixpos % buflen;
+        if ((frames = min(count, (buflen - pos) / istride)))
+            dsb->convert(buffer + pos, dst, frames * channels);
+        else
+        {
+            /* partial frame at the end of the buffer */
+            for (channel = 0; channel < channels; channel++)
+                dst[channel] = get_current_sample(dsb, buffer, buflen, mixpos, channel);
+            frames = 1;
+        }
+
+        dst += frames * channels;
+        mixpos += frames * istride;
+        count -= frames;
+    }
+}
+
 static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
 {
     UINT istride = dsb->pwfx->nBlockAlign;
@@ -301,6 +340,15 @@ static UINT cp_fields_noresample(IDirectSoundBufferImpl *dsb, UINT count)
         committed_samples = committed_samples <= count ? committed_samples : count;
     }
 
+    if (dsb->convert)
+    {
+        convert_current_samples(dsb, dsb->committedbuff, dsb->writelead, dsb->committed_mixpos,
+                committed_samples, dsb->device->tmp_buffer);
+        convert_current_samples(dsb, dsb->buffer->memory, dsb->buflen, dsb->sec_mixpos + committed_samples * istride,
+                count - committed_samples, dsb->device->tmp_buffer + committed_samples * dsb->mix_channels);
+        return count;
+    }
+
     for (i = 0; i < committed_samples; i++)
         for (channel = 0; channel < dsb->mix_channels; channel++)
             dsb->put(dsb, i * ostride, channel, get_current_sample(dsb, dsb->committedbuff,
@@ -298,6 +298,13 @@ struct dwrite_fontface
     IDWriteLocalizedStrings *names;
 
     struct scriptshaping_cache *shaping_cache;
+    struct
+    {
+        struct list entries;
+        unsigned int count;
+        unsigned int hits;
+        unsigned int misses;
+    } shaped_runs;
 
     LOGFONTW lf;
 };
@@ -376,6 +383,7 @@ struct dwrite_fontface;
 extern float fontface_get_scaled_design_advance(struct dwrite_fontface *fontface, DWRITE_MEASURING_MODE measuring_mode,
         float emsize, float ppdip, const DWRITE_MATRIX *transform, UINT16 glyph, BOOL is_sideways);
 extern struct dwrite_fontface *unsafe_impl_from_IDWriteFontFace(IDWriteFontFace *iface);
+extern void fontface_release_shaped_runs(struct dwrite_fontface *fontface);
 
 struct dwrite_textformat_data
 {
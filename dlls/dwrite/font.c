@@ -265,6 +265,7 @@ static void fontface_cache_init(struct dwrite_fontface *fontface)
     wine_rb_init(&fontface->cache.tree, fontface_cache_compare);
     list_init(&fontface->cache.mru);
     fontface->cache.max_size = 0x8000;
+    list_init(&fontface->shaped_runs.entries);
 }
 
 static void fontface_cache_clear(struct dwrite_fontface *fontface)
@@ -857,6 +858,7 @@ static ULONG WINAPI dwritefontface_Release(IDWriteFontFace5 *iface)
             free(fontface->cached);
         }
         release_scriptshaping_cache(fontface->shaping_cache);
+        fontface_release_shaped_runs(fontface);
         if (fontface->vdmx.context)
             IDWriteFontFace5_ReleaseFontTable(iface, fontface->vdmx.context);
         if (fontface->gasp.context)
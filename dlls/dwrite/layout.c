@@ -950,7 +950,6 @@ static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct
     unsigned int max_count;
     HRESULT hr;
 
-    run->descr.localeName = get_layout_range_by_pos(layout, run->descr.textPosition)->locale;
     run->clustermap = calloc(run->descr.stringLength, sizeof(*run->clustermap));
     if (!run->clustermap)
         return E_OUTOFMEMORY;
@@ -965,9 +964,6 @@ static HRESULT layout_shape_get_glyphs(struct dwrite_textlayout *layout, struct
     if (!context->text_props || !context->glyph_props)
         return E_OUTOFMEMORY;
 
-    if (FAILED(hr = layout_shape_get_user_features(layout, context)))
-        return hr;
-
     for (;;)
     {
         hr = IDWriteTextAnalyzer2_GetGlyphs(context->analyzer, run->descr.string, run->descr.stringLength, run->run.fontFace,
@@ -1114,25 +1110,252 @@ static HRESULT layout_shape_get_positions(struct dwrite_textlayout *layout, stru
         WARN("%s: failed to get glyph placement info, hr %#lx.\n", debugstr_rundescr(&run->descr), hr);
     }
 
-    if (SUCCEEDED(hr))
-        hr = layout_shape_apply_character_spacing(layout, context);
-
     run->run.glyphAdvances = run->advances;
     run->run.glyphOffsets = run->offsets;
 
     return hr;
 }
 
+/* Shaping results are cached per font face, so that layouts created repeatedly for the same
+   strings don't have to go through glyph substitution and positioning again. Entries don't hold
+   a reference to the face, they are released together with it. Runs using user features are
+   not cached. */
+
+struct shaping_cache_entry
+{
+    struct list entry;
+    unsigned int hash;
+
+    /* Key */
+    WCHAR *text;
+    unsigned int length;
+    float emsize;
+    BOOL is_sideways;
+    BOOL is_rtl;
+    DWRITE_SCRIPT_ANALYSIS sa;
+    WCHAR locale[LOCALE_NAME_MAX_LENGTH];
+    DWRITE_MEASURING_MODE measuring_mode;
+    float ppdip;
+    DWRITE_MATRIX transform;
+
+    /* Shaping output */
+    unsigned int glyph_count;
+    UINT16 *clustermap;
+    DWRITE_SHAPING_TEXT_PROPERTIES *text_props;
+    UINT16 *glyphs;
+    DWRITE_SHAPING_GLYPH_PROPERTIES *glyph_props;
+    float *advances;
+    DWRITE_GLYPH_OFFSET *offsets;
+};
+
+#define SHAPING_CACHE_MAX_ENTRIES 64
+
+static void shaping_cache_init_key(const struct dwrite_textlayout *layout, const struct regular_layout_run *run,
+        struct shaping_cache_entry *key)
+{
+    const unsigned char *ptr;
+    unsigned int i, hash = 2166136261u;
+
+    memset(key, 0, sizeof(*key));
+    key->text = (WCHAR *)run->descr.string;
+    key->length = run->descr.stringLength;
+    key->emsize = run->run.fontEmSize;
+    key->is_sideways = run->run.isSideways;
+    key->is_rtl = run->run.bidiLevel & 1;
+    key->sa.script = run->sa.script;
+    key->sa.shapes = run->sa.shapes;
+    if (run->descr.localeName) wcsncpy(key->locale, run->descr.localeName, ARRAY_SIZE(key->locale) - 1);
+    key->measuring_mode = layout->measuringmode;
+    if (is_layout_gdi_compatible(layout))
+    {
+        key->ppdip = layout->ppdip;
+        key->transform = layout->transform;
+    }
+
+    for (i = 0, ptr = (const unsigned char *)key->text; i < key->length * sizeof(WCHAR); ++i)
+        hash = (hash ^ ptr[i]) * 16777619u;
+    for (ptr = (const unsigned char *)&key->emsize; ptr < (const unsigned char *)key->locale; ++ptr)
+        hash = (hash ^ *ptr) * 16777619u;
+    key->hash = hash;
+}
+
+static BOOL shaping_cache_key_equal(const struct shaping_cache_entry *key, const struct shaping_cache_entry *entry)
+{
+    return key->hash == entry->hash && key->length == entry->length
+            && key->emsize == entry->emsize && key->is_sideways == entry->is_sideways && key->is_rtl == entry->is_rtl
+            && key->sa.script == entry->sa.script && key->sa.shapes == entry->sa.shapes
+            && key->measuring_mode == entry->measuring_mode
+            && key->ppdip == entry->ppdip && !memcmp(&key->transform, &entry->transform, sizeof(key->transform))
+            && !wcscmp(key->locale, entry->locale) && !memcmp(key->text, entry->text, key->length * sizeof(WCHAR));
+}
+
+static BOOL layout_shape_get_cached(const struct dwrite_textlayout *layout, struct shaping_context *context)
+{
+    struct regular_layout_run *run = context->run;
+    struct dwrite_fontface *fontface = unsafe_impl_from_IDWriteFontFace(run->run.fontFace);
+    struct shaping_cache_entry key, *entry;
+    unsigned int length = run->descr.stringLength, count;
+    BOOL found = FALSE;
+
+    shaping_cache_init_key(layout, run, &key);
+
+    EnterCriticalSection(&fontface->cs);
+
+    LIST_FOR_EACH_ENTRY(entry, &fontface->shaped_runs.entries, struct shaping_cache_entry, entry)
+    {
+        if (!shaping_cache_key_equal(&key, entry)) continue;
+
+        count = entry->glyph_count;
+        run->clustermap = malloc(length * sizeof(*run->clustermap));
+        run->glyphs = malloc(count * sizeof(*run->glyphs));
+        run->advances = malloc(count * sizeof(*run->advances));
+        run->offsets = malloc(count * sizeof(*run->offsets));
+        context->text_props = malloc(length * sizeof(*context->text_props));
+        context->glyph_props = malloc(count * sizeof(*context->glyph_props));
+        if (!run->clustermap || !run->glyphs || !run->advances || !run->offsets || !context->text_props
+                || !context->glyph_props)
+            break;
+
+        memcpy(run->clustermap, entry->clustermap, length * sizeof(*run->clustermap));
+        memcpy(run->glyphs, entry->glyphs, count * sizeof(*run->glyphs));
+        memcpy(run->advances, entry->advances, count * sizeof(*run->advances));
+        memcpy(run->offsets, entry->offsets, count * sizeof(*run->offsets));
+        memcpy(context->text_props, entry->text_props, length * sizeof(*context->text_props));
+        memcpy(context->glyph_props, entry->glyph_props, count * sizeof(*context->glyph_props));
+        run->glyphcount = count;
+
+        run->run.glyphIndices = run->glyphs;
+        run->run.glyphAdvances = run->advances;
+        run->run.glyphOffsets = run->offsets;
+        run->descr.clusterMap = run->clustermap;
+
+        list_remove(&entry->entry);
+        list_add_head(&fontface->shaped_runs.entries, &entry->entry);
+        found = TRUE;
+        break;
+    }
+
+    if (found) fontface->shaped_runs.hits++;
+    else fontface->shaped_runs.misses++;
+    TRACE("%s: %s, hits %u, misses %u.\n", debugstr_rundescr(&run->descr), found ? "hit" : "miss",
+            fontface->shaped_runs.hits, fontface->shaped_runs.misses);
+
+    LeaveCriticalSection(&fontface->cs);
+
+    if (!found)
+    {
+        /* Let the shaping path allocate the arrays again. */
+        free(run->clustermap);
+        free(run->glyphs);
+        free(run->advances);
+        free(run->offsets);
+        free(context->text_props);
+        free(context->glyph_props);
+        run->clustermap = run->glyphs = NULL;
+        run->advances = NULL;
+        run->offsets = NULL;
+        context->text_props = NULL;
+        context->glyph_props = NULL;
+    }
+
+    return found;
+}
+
+static void layout_shape_set_cached(const struct dwrite_textlayout *layout, const struct shaping_context *context)
+{
+    const struct regular_layout_run *run = context->run;
+    struct dwrite_fontface *fontface = unsafe_impl_from_IDWriteFontFace(run->run.fontFace);
+    unsigned int length = run->descr.stringLength, count = run->glyphcount;
+    struct shaping_cache_entry key, *entry;
+    char *ptr;
+
+    shaping_cache_init_key(layout, run, &key);
+
+    if (!(entry = malloc(sizeof(*entry) + length * (sizeof(*entry->text) + sizeof(*entry->clustermap)
+            + sizeof(*entry->text_props)) + count * (sizeof(*entry->glyphs) + sizeof(*entry->glyph_props)
+            + sizeof(*entry->advances) + sizeof(*entry->offsets)))))
+        return;
+
+    *entry = key;
+    entry->glyph_count = count;
+
+    /* Keep 4-byte aligned arrays first. */
+    ptr = (char *)(entry + 1);
+    entry->advances = (float *)ptr;
+    ptr += count * sizeof(*entry->advances);
+    entry->offsets = (DWRITE_GLYPH_OFFSET *)ptr;
+    ptr += count * sizeof(*entry->offsets);
+    entry->text_props = (DWRITE_SHAPING_TEXT_PROPERTIES *)ptr;
+    ptr += length * sizeof(*entry->text_props);
+    entry->glyph_props = (DWRITE_SHAPING_GLYPH_PROPERTIES *)ptr;
+    ptr += count * sizeof(*entry->glyph_props);
+    entry->text = (WCHAR *)ptr;
+    ptr += length * sizeof(*entry->text);
+    entry->clustermap = (UINT16 *)ptr;
+    ptr += length * sizeof(*entry->clustermap);
+    entry->glyphs = (UINT16 *)ptr;
+
+    memcpy(entry->text, run->descr.string, length * sizeof(*entry->text));
+    memcpy(entry->clustermap, run->clustermap, length * sizeof(*entry->clustermap));
+    memcpy(entry->text_props, context->text_props, length * sizeof(*entry->text_props));
+    memcpy(entry->glyphs, run->glyphs, count * sizeof(*entry->glyphs));
+    memcpy(entry->glyph_props, context->glyph_props, count * sizeof(*entry->glyph_props));
+    memcpy(entry->advances, run->advances, count * sizeof(*entry->advances));
+    memcpy(entry->offsets, run->offsets, count * sizeof(*entry->offsets));
+
+    EnterCriticalSection(&fontface->cs);
+
+    list_add_head(&fontface->shaped_runs.entries, &entry->entry);
+    if (++fontface->shaped_runs.count > SHAPING_CACHE_MAX_ENTRIES)
+    {
+        entry = LIST_ENTRY(list_tail(&fontface->shaped_runs.entries), struct shaping_cache_entry, entry);
+        list_remove(&entry->entry);
+        free(entry);
+        fontface->shaped_runs.count--;
+    }
+
+    LeaveCriticalSection(&fontface->cs);
+}
+
+void fontface_release_shaped_runs(struct dwrite_fontface *fontface)
+{
+    struct shaping_cache_entry *entry, *next;
+
+    TRACE("Shaping cache hits %u, misses %u.\n", fontface->shaped_runs.hits, fontface->shaped_runs.misses);
+
+    LIST_FOR_EACH_ENTRY_SAFE(entry, next, &fontface->shaped_runs.entries, struct shaping_cache_entry, entry)
+    {
+        list_remove(&entry->entry);
+        free(entry);
+    }
+    fontface->shaped_runs.count = 0;
+}
+
 static HRESULT layout_shape_run(struct dwrite_textlayout *layout, struct regular_layout_run *run)
 {
     struct shaping_context context = { 0 };
+    BOOL cacheable;
     HRESULT hr;
 
     context.analyzer = get_text_analyzer();
     context.run = run;
 
-    if (SUCCEEDED(hr = layout_shape_get_glyphs(layout, &context)))
-        hr = layout_shape_get_positions(layout, &context);
+    run->descr.localeName = get_layout_range_by_pos(layout, run->descr.textPosition)->locale;
+
+    if (FAILED(hr = layout_shape_get_user_features(layout, &context)))
+        return hr;
+    cacheable = !context.user_features.range_count;
+
+    if (!cacheable || !layout_shape_get_cached(layout, &context))
+    {
+        if (SUCCEEDED(hr = layout_shape_get_glyphs(layout, &context)))
+            hr = layout_shape_get_positions(layout, &context);
+        if (SUCCEEDED(hr) && cacheable)
+            layout_shape_set_cached(layout, &context);
+    }
+
+    if (SUCCEEDED(hr))
+        hr = layout_shape_apply_character_spacing(layout, &context);
 
     layout_shape_clear_context(&context);
 
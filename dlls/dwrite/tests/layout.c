@@ -876,6 +876,14 @@ static ULONG WINAPI testrenderer_Release(IDWriteTextRenderer *iface)
     return 1;
 }
 
+struct glyph_run_record
+{
+    UINT32 glyph_count;
+    UINT16 glyphs[32];
+    FLOAT advances[32];
+    DWRITE_GLYPH_OFFSET offsets[32];
+};
+
 struct renderer_context {
     BOOL gdicompat;
     BOOL use_gdi_natural;
@@ -886,6 +894,7 @@ struct renderer_context {
     FLOAT originY;
     IDWriteTextFormat *format;
     const WCHAR *familyW;
+    struct glyph_run_record *record;
 };
 
 static HRESULT WINAPI testrenderer_IsPixelSnappingDisabled(IDWriteTextRenderer *iface,
@@ -948,6 +957,16 @@ static HRESULT WINAPI testrenderer_DrawGlyphRun(IDWriteTextRenderer *iface,
         ctxt->originY = baselineOriginY;
     }
 
+    if (ctxt && ctxt->record && ctxt->record->glyph_count + run->glyphCount <= ARRAY_SIZE(ctxt->record->glyphs))
+    {
+        struct glyph_run_record *record = ctxt->record;
+
+        memcpy(&record->glyphs[record->glyph_count], run->glyphIndices, run->glyphCount * sizeof(*run->glyphIndices));
+        memcpy(&record->advances[record->glyph_count], run->glyphAdvances, run->glyphCount * sizeof(*run->glyphAdvances));
+        memcpy(&record->offsets[record->glyph_count], run->glyphOffsets, run->glyphCount * sizeof(*run->glyphOffsets));
+        record->glyph_count += run->glyphCount;
+    }
+
     ok(descr->stringLength < ARRAY_SIZE(entry.string), "string is too long\n");
     if (descr->stringLength && descr->stringLength < ARRAY_SIZE(entry.string)) {
         memcpy(entry.string, descr->string, descr->stringLength*sizeof(WCHAR));
@@ -7052,6 +7071,58 @@ if (SUCCEEDED(hr))
     IDWriteFactory_Release(factory);
 }
 
+static void test_shaping_cache(void)
+{
+    static const WCHAR strW[] = L"Shaped run";
+    struct glyph_run_record records[2];
+    struct renderer_context ctxt;
+    IDWriteTextFormat *format;
+    IDWriteTextLayout *layout;
+    IDWriteFontFace *fontface;
+    IDWriteFactory *factory;
+    unsigned int i;
+    ULONG refcount;
+    HRESULT hr;
+
+    factory = create_factory();
+
+    hr = IDWriteFactory_CreateTextFormat(factory, L"Tahoma", NULL, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL,
+            DWRITE_FONT_STRETCH_NORMAL, 10.0f, L"en-us", &format);
+    ok(hr == S_OK, "Failed to create text format, hr %#lx.\n", hr);
+
+    fontface = get_fontface_from_format(format);
+    IDWriteFontFace_AddRef(fontface);
+    refcount = IDWriteFontFace_Release(fontface);
+
+    memset(&ctxt, 0, sizeof(ctxt));
+    ctxt.snapping_disabled = TRUE;
+    memset(records, 0, sizeof(records));
+
+    /* Layouts for the same text give the same glyph runs, whether they were shaped or not. */
+    for (i = 0; i < ARRAY_SIZE(records); ++i)
+    {
+        hr = IDWriteFactory_CreateTextLayout(factory, strW, wcslen(strW), format, 1000.0f, 1000.0f, &layout);
+        ok(hr == S_OK, "Failed to create text layout, hr %#lx.\n", hr);
+
+        ctxt.record = &records[i];
+        hr = IDWriteTextLayout_Draw(layout, &ctxt, &testrenderer, 0.0f, 0.0f);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+        IDWriteTextLayout_Release(layout);
+    }
+    flush_sequence(sequences, RENDERER_ID);
+
+    ok(records[0].glyph_count == wcslen(strW), "Unexpected glyph count %u.\n", records[0].glyph_count);
+    ok(!memcmp(&records[0], &records[1], sizeof(*records)), "Got different glyph runs.\n");
+
+    /* Released layouts don't keep their font faces alive. */
+    EXPECT_REF(fontface, refcount);
+
+    IDWriteFontFace_Release(fontface);
+    IDWriteTextFormat_Release(format);
+    IDWriteFactory_Release(factory);
+}
+
 START_TEST(layout)
 {
     IDWriteFactory *factory;
@@ -7108,6 +7179,7 @@ START_TEST(layout)
     test_text_format_axes();
     test_layout_range_length();
     test_HitTestTextRange();
+    test_shaping_cache();
 
     IDWriteFactory_Release(factory);
 }
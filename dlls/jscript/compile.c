@@ -286,6 +286,7 @@ static unsigned push_instr(compiler_ctx_t *ctx, jsop_t op)
 
     ctx->code->instrs[ctx->code_off].op = op;
     ctx->code->instrs[ctx->code_off].loc = ctx->loc;
+    memset(&ctx->code->instrs[ctx->code_off].u, 0, sizeof(ctx->code->instrs[ctx->code_off].u));
     return ctx->code_off++;
 }
 
@@ -2356,6 +2356,21 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+/* Same as jsdisp_get_id, but tries the slot of the hint DISPID first. Objects
+ * created the same way store their properties in the same slots, so an id
+ * returned for another object is often valid for this one as well. */
+HRESULT jsdisp_get_id_hint(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID hint, DISPID *id)
+{
+    dispex_prop_t *prop;
+
+    if(!(flags & fdexNameCaseInsensitive) && (prop = get_prop(jsdisp, hint)) && !wcscmp(prop->name, name)) {
+        *id = hint;
+        return S_OK;
+    }
+
+    return jsdisp_get_id(jsdisp, name, flags, id);
+}
+
 HRESULT jsdisp_get_idx_id(jsdisp_t *jsdisp, DWORD idx, DISPID *id)
 {
     WCHAR name[11];
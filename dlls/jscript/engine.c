@@ -626,6 +626,25 @@ static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name
     return hres;
 }
 
+/* Property lookup for instructions that keep the last DISPID they got in their
+ * second argument and pass it as a hint to the next lookup. */
+static HRESULT disp_get_id_cached(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags, DISPID *id)
+{
+    call_frame_t *frame = ctx->call_ctx;
+    instr_arg_t *cache = &frame->bytecode->instrs[frame->ip].u.arg[1];
+    jsdisp_t *jsdisp;
+    HRESULT hres;
+
+    jsdisp = to_jsdisp(disp);
+    if(!jsdisp)
+        return disp_get_id(ctx, disp, name, name_bstr, flags, id);
+
+    hres = jsdisp_get_id_hint(jsdisp, name, flags, cache->lng, id);
+    if(SUCCEEDED(hres))
+        cache->lng = *id;
+    return hres;
+}
+
 static HRESULT disp_cmp(IDispatch *disp1, IDispatch *disp2, BOOL *ret)
 {
     IObjectIdentity *identity;
@@ -1442,7 +1461,7 @@ static HRESULT interp_member(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, arg, arg, 0, &id);
+    hres = disp_get_id_cached(ctx, obj, arg, arg, 0, &id);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
@@ -1484,7 +1503,7 @@ static HRESULT interp_memberid(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, name, NULL, arg, &id);
+    hres = disp_get_id_cached(ctx, obj, name, NULL, arg, &id);
     jsstr_release(name_str);
     if(SUCCEEDED(hres)) {
         ref.type = EXPRVAL_IDREF;
@@ -2049,6 +2049,29 @@ ok(tmp, "tmp = " + tmp);
     ok(x === undefined, "x = " + x);
 })();
 
+(function() {
+    function C() { this.a = 1; }
+    function getb(o) { return o.b; }
+    C.prototype.b = 2;
+
+    var o = new C(), objs = [{a: 1, b: 2}, {b: 3, a: 4}, o, {c: 6}], i, r = "";
+
+    for(i = 0; i < objs.length; i++)
+        r += getb(objs[i]) + ";";
+    ok(r === "2;3;2;undefined;", "r = " + r);
+
+    o.b = 10;
+    ok(getb(o) === 10, "getb(o) = " + getb(o));
+    delete o.b;
+    ok(getb(o) === 2, "getb(o) = " + getb(o));
+    delete C.prototype.b;
+    ok(getb(o) === undefined, "getb(o) = " + getb(o));
+    C.prototype.b = 3;
+    ok(getb(o) === 3, "getb(o) = " + getb(o));
+    ok(getb(objs[1]) === 3, "getb(objs[1]) = " + getb(objs[1]));
+    ok(getb(objs[3]) === undefined, "getb(objs[3]) = " + getb(objs[3]));
+})();
+
 var get, set;
 
 /* NoNewline rule parser tests */
@@ -2124,7 +2124,7 @@ static void test_import_resolution(void)
     void *expect, *tmp;
     char *str;
     SIZE_T size;
-    HANDLE hfile, mapping;
+    HANDLE hfile, mapping, mapping2;
     HMODULE mod, mod2;
     NTSTATUS status;
     LARGE_INTEGER offset;
@@ -2398,6 +2398,38 @@ static void test_import_resolution(void)
                     "tls not relocated %p / %p\n", (void *)ptr->tls.StartAddressOfRawData,
                     (char *)mod + DATA_RVA( data.tls_data ));
             }
+            if (test == 4)
+            {
+                /* a new mapping of the file gets the same relocations */
+                UnmapViewOfFile( mod );
+                hfile = CreateFileA(dll_name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, 0);
+                ok( hfile != INVALID_HANDLE_VALUE, "CreateFile failed err %lu\n", GetLastError() );
+                mapping2 = CreateFileMappingA( hfile, NULL, SEC_IMAGE | PAGE_READONLY, 0, 0, NULL );
+                ok( mapping2 != 0, "CreateFileMappingA failed err %lu\n", GetLastError() );
+                CloseHandle( hfile );
+                mod = NULL;
+                size = 0;
+                status = pNtMapViewOfSection( mapping2, GetCurrentProcess(), (void **)&mod, 0, 0, &offset,
+                                              &size, 1 /* ViewShare */, 0, PAGE_READONLY );
+                ok( !status, "NtMapViewOfSection failed %lx\n", status );
+                ok( mod != (void *)nt.OptionalHeader.ImageBase,  "loaded at image base %p\n", mod );
+                pnt = pRtlImageNtHeader( mod );
+                ptr = (void *)((char *)mod + page_size);
+                ok( (void *)pnt->OptionalHeader.ImageBase == mod, "not at base %p / %p\n",
+                    (void *)pnt->OptionalHeader.ImageBase, mod );
+                ok( (char *)ptr->tls.StartAddressOfRawData == (char *)mod + DATA_RVA( data.tls_data ),
+                    "tls not relocated %p / %p\n", (void *)ptr->tls.StartAddressOfRawData,
+                    (char *)mod + DATA_RVA( data.tls_data ));
+                ok( (char *)ptr->tls.EndAddressOfRawData == (char *)mod + DATA_RVA( data.tls_data ) + sizeof(data.tls_data),
+                    "tls end not relocated %p / %p\n", (void *)ptr->tls.EndAddressOfRawData,
+                    (char *)mod + DATA_RVA( data.tls_data ) + sizeof(data.tls_data));
+                ok( (char *)ptr->tls.AddressOfIndex == (char *)mod + DATA_RVA( &data.tls_index ),
+                    "tls index not relocated %p / %p\n", (void *)ptr->tls.AddressOfIndex,
+                    (char *)mod + DATA_RVA( &data.tls_index ));
+                ok( !strcmp( ptr->tls_data, "hello world" ), "wrong tls data '%s'\n", ptr->tls_data );
+                ok( ptr->tls_index == 9999, "wrong tls index %d\n", ptr->tls_index );
+                CloseHandle( mapping2 );
+            }
             UnmapViewOfFile( mod );
             CloseHandle( mapping );
             if (tmp) VirtualFree( tmp, 0, MEM_RELEASE );
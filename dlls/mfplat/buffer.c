@@ -45,6 +45,7 @@ struct buffer
     BYTE *data;
     DWORD max_length;
     DWORD current_length;
+    DWORD alignment;
 
     struct
     {
@@ -76,6 +77,99 @@ struct buffer
     CRITICAL_SECTION cs;
 };
 
+/* Large buffers are typically video frames, which are allocated and released
+ * at a high rate with the same sizes. Keep a few of them around, instead of
+ * returning them to the heap every time. */
+#define BUFFER_POOL_MIN_SIZE 0x10000
+#define BUFFER_POOL_MAX_COUNT 32
+#define BUFFER_POOL_MAX_SIZE (128 * 1024 * 1024)
+
+static struct
+{
+    struct
+    {
+        BYTE *data;
+        DWORD size;
+        DWORD alignment;
+    } entries[BUFFER_POOL_MAX_COUNT];
+    unsigned int count;
+    SIZE_T size;
+    LONG hits, misses;
+} buffer_pool;
+
+static CRITICAL_SECTION buffer_pool_cs;
+static CRITICAL_SECTION_DEBUG buffer_pool_cs_debug =
+{
+    0, 0, &buffer_pool_cs,
+    { &buffer_pool_cs_debug.ProcessLocksList, &buffer_pool_cs_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": buffer_pool_cs") }
+};
+static CRITICAL_SECTION buffer_pool_cs = { &buffer_pool_cs_debug, -1, 0, 0, 0, 0 };
+
+static BYTE *buffer_pool_alloc(DWORD size, DWORD alignment)
+{
+    BYTE *data = NULL;
+    unsigned int i;
+
+    if (size < BUFFER_POOL_MIN_SIZE)
+        return _aligned_malloc(size, alignment);
+
+    EnterCriticalSection(&buffer_pool_cs);
+    for (i = 0; i < buffer_pool.count; ++i)
+    {
+        /* Accept a slightly larger block, to allow for small variations in
+         * the requested size. */
+        if (buffer_pool.entries[i].alignment == alignment && buffer_pool.entries[i].size >= size
+                && buffer_pool.entries[i].size - size <= size / 8)
+        {
+            data = buffer_pool.entries[i].data;
+            buffer_pool.size -= buffer_pool.entries[i].size;
+            memmove(&buffer_pool.entries[i], &buffer_pool.entries[i + 1],
+                    (--buffer_pool.count - i) * sizeof(*buffer_pool.entries));
+            break;
+        }
+    }
+    LeaveCriticalSection(&buffer_pool_cs);
+
+    if (data)
+    {
+        TRACE("Reusing block %p, size %lu, %ld hits, %ld misses.\n", data, size,
+                InterlockedIncrement(&buffer_pool.hits), buffer_pool.misses);
+        return data;
+    }
+
+    TRACE("Allocating new block, size %lu, %ld hits, %ld misses.\n", size,
+            buffer_pool.hits, InterlockedIncrement(&buffer_pool.misses));
+    return _aligned_malloc(size, alignment);
+}
+
+/* "size" may be smaller than the size the block was allocated with, if the
+ * block was reused for a smaller buffer. */
+static void buffer_pool_free(BYTE *data, DWORD size, DWORD alignment)
+{
+    if (!data || size < BUFFER_POOL_MIN_SIZE || size > BUFFER_POOL_MAX_SIZE)
+    {
+        _aligned_free(data);
+        return;
+    }
+
+    EnterCriticalSection(&buffer_pool_cs);
+    /* Evict the oldest blocks to make room. */
+    while (buffer_pool.count == BUFFER_POOL_MAX_COUNT || buffer_pool.size + size > BUFFER_POOL_MAX_SIZE)
+    {
+        _aligned_free(buffer_pool.entries[0].data);
+        buffer_pool.size -= buffer_pool.entries[0].size;
+        memmove(&buffer_pool.entries[0], &buffer_pool.entries[1],
+                --buffer_pool.count * sizeof(*buffer_pool.entries));
+    }
+    buffer_pool.entries[buffer_pool.count].data = data;
+    buffer_pool.entries[buffer_pool.count].size = size;
+    buffer_pool.entries[buffer_pool.count].alignment = alignment;
+    ++buffer_pool.count;
+    buffer_pool.size += size;
+    LeaveCriticalSection(&buffer_pool_cs);
+}
+
 static void copy_image(const struct buffer *buffer, BYTE *dest, LONG dest_stride, const BYTE *src,
         LONG src_stride, DWORD width, DWORD lines)
 {
@@ -173,7 +267,7 @@ static ULONG WINAPI memory_buffer_Release(IMFMediaBuffer *iface)
         }
         DeleteCriticalSection(&buffer->cs);
         free(buffer->_2d.linear_buffer);
-        _aligned_free(buffer->data);
+        buffer_pool_free(buffer->data, buffer->max_length, buffer->alignment);
         free(buffer);
     }
 
@@ -1350,13 +1444,14 @@ static HRESULT memory_buffer_init(struct buffer *buffer, DWORD max_length, DWORD
         alignment++;
     }
 
-    if (!(buffer->data = _aligned_malloc(max_length, alignment)))
+    if (!(buffer->data = buffer_pool_alloc(max_length, alignment)))
         return E_OUTOFMEMORY;
     memset(buffer->data, 0, max_length);
 
     buffer->IMFMediaBuffer_iface.lpVtbl = vtbl;
     buffer->refcount = 1;
     buffer->max_length = max_length;
+    buffer->alignment = alignment;
     buffer->current_length = 0;
     InitializeCriticalSection(&buffer->cs);
 
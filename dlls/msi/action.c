@@ -562,15 +562,17 @@ MSIFEATURE *msi_get_loaded_feature(MSIPACKAGE* package, const WCHAR *Feature )
     return NULL;
 }
 
+int msi_compare_file_key( const void *key, const struct rb_entry *entry )
+{
+    return wcscmp( key, RB_ENTRY_VALUE( entry, const MSIFILE, key_entry )->File );
+}
+
 MSIFILE *msi_get_loaded_file( MSIPACKAGE *package, const WCHAR *key )
 {
-    MSIFILE *file;
+    struct rb_entry *entry;
 
-    LIST_FOR_EACH_ENTRY( file, &package->files, MSIFILE, entry )
-    {
-        if (!wcscmp( key, file->File )) return file;
-    }
-    return NULL;
+    if (!(entry = rb_get( &package->file_keys, key ))) return NULL;
+    return RB_ENTRY_VALUE( entry, MSIFILE, key_entry );
 }
 
 MSIFOLDER *msi_get_loaded_folder( MSIPACKAGE *package, const WCHAR *dir )
@@ -1083,6 +1085,8 @@ static UINT load_file(MSIRECORD *row, LPVOID param)
     TRACE("File loaded (file %s sequence %u)\n", debugstr_w(file->File), file->Sequence);
 
     list_add_tail( &package->files, &file->entry );
+    if (rb_put( &package->file_keys, file->File, &file->key_entry ))
+        WARN("duplicate file key %s\n", debugstr_w(file->File));
     return ERROR_SUCCESS;
 }
 
@@ -504,6 +504,11 @@ static MSIFILE *find_file( MSIPACKAGE *package, UINT disk_id, const WCHAR *filen
 {
     MSIFILE *file;
 
+    /* cabinet entries are normally named after the file key, fall back to
+     * a case insensitive search for the rest */
+    if ((file = msi_get_loaded_file( package, filename )) &&
+        file->disk_id == disk_id && file->state != msifs_installed) return file;
+
     LIST_FOR_EACH_ENTRY( file, &package->files, MSIFILE, entry )
     {
         if (file->disk_id == disk_id &&
@@ -1593,8 +1598,11 @@ UINT ACTION_RemoveFiles( MSIPACKAGE *package )
 
         TRACE("removing %s\n", debugstr_w(file->File) );
 
-        msi_set_file_attributes( package, file->TargetPath, FILE_ATTRIBUTE_NORMAL );
-        if (!msi_delete_file( package, file->TargetPath ))
+        /* only reset the attributes when a read-only file gets in the way */
+        if (!msi_delete_file( package, file->TargetPath ) &&
+            (GetLastError() != ERROR_ACCESS_DENIED ||
+             !msi_set_file_attributes( package, file->TargetPath, FILE_ATTRIBUTE_NORMAL ) ||
+             !msi_delete_file( package, file->TargetPath )))
         {
             WARN( "failed to delete %s (%lu)\n",  debugstr_w(file->TargetPath), GetLastError() );
         }
@@ -36,6 +36,7 @@
 #include "winnls.h"
 #include "winver.h"
 #include "wine/list.h"
+#include "wine/rbtree.h"
 #include "wine/debug.h"
 
 #include "msiserver.h"
@@ -226,7 +227,7 @@ typedef struct _column_info
     struct _column_info *next;
 } column_info;
 
-typedef const struct tagMSICOLUMNHASHENTRY *MSIITERHANDLE;
+typedef const struct column_hash_entry *MSIITERHANDLE;
 
 typedef struct tagMSIVIEWOPS
 {
@@ -347,6 +348,16 @@ typedef struct tagMSIVIEWOPS
      * drop - drops the table from the database
      */
     UINT (*drop)( struct tagMSIVIEW *view );
+
+    /*
+     * find_matching_rows - iterates through the rows where a column has a given value
+     *
+     *  The value is the one returned by fetch_int, i.e. a string ID for string
+     *   columns. The handle keeps track of the position in the iteration, it
+     *   must be set to NULL before the first call.
+     *  The iteration is no longer valid once the view data is modified.
+     */
+    UINT (*find_matching_rows)( struct tagMSIVIEW *view, UINT col, UINT val, UINT *row, MSIITERHANDLE *handle );
 } MSIVIEWOPS;
 
 struct tagMSIVIEW
@@ -401,6 +412,7 @@ typedef struct tagMSIPACKAGE
     struct list components;
     struct list features;
     struct list files;
+    struct rb_tree file_keys;
     struct list filepatches;
     struct list tempfiles;
     struct list folders;
@@ -602,6 +614,7 @@ typedef enum _msi_file_state {
 typedef struct tagMSIFILE
 {
     struct list entry;
+    struct rb_entry key_entry;
     LPWSTR File;
     MSICOMPONENT *Component;
     LPWSTR FileName;
@@ -1038,6 +1051,7 @@ extern void msi_reset_source_folders( MSIPACKAGE *package );
 extern MSICOMPONENT *msi_get_loaded_component(MSIPACKAGE *package, const WCHAR *Component);
 extern MSIFEATURE *msi_get_loaded_feature(MSIPACKAGE *package, const WCHAR *Feature);
 extern MSIFILE *msi_get_loaded_file(MSIPACKAGE *package, const WCHAR *file);
+extern int msi_compare_file_key(const void *key, const struct rb_entry *entry);
 extern MSIFOLDER *msi_get_loaded_folder(MSIPACKAGE *package, const WCHAR *dir);
 extern WCHAR *msi_create_temp_file(MSIDATABASE *db) __WINE_DEALLOC(free) __WINE_MALLOC;
 extern void msi_free_action_script(MSIPACKAGE *package, UINT script);
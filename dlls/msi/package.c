@@ -918,6 +918,7 @@ static MSIPACKAGE *alloc_package( void )
         list_init( &package->components );
         list_init( &package->features );
         list_init( &package->files );
+        rb_init( &package->file_keys, msi_compare_file_key );
         list_init( &package->filepatches );
         list_init( &package->tempfiles );
         list_init( &package->folders );
@@ -361,6 +361,23 @@ static void free_colinfo( struct column_info *colinfo, UINT count )
     for (i = 0; i < count; i++) free( colinfo[i].hash_table );
 }
 
+/* the hash tables are indexed by row, they need to be rebuilt when rows are added or removed */
+static void reset_hash_tables( struct column_info *colinfo, UINT count )
+{
+    UINT i;
+
+    for (i = 0; i < count; i++)
+    {
+        free( colinfo[i].hash_table );
+        colinfo[i].hash_table = NULL;
+    }
+}
+
+static inline UINT get_hash_table_size( const MSITABLE *table )
+{
+    return max( MSITABLE_HASH_TABLE_SIZE, table->row_count | 1 );
+}
+
 static void free_table( MSITABLE *table )
 {
     UINT i;
@@ -1520,6 +1537,8 @@ static UINT table_create_new_row( struct tagMSIVIEW *view, UINT *num, BOOL tempo
         return ERROR_NOT_ENOUGH_MEMORY;
     }
 
+    reset_hash_tables( tv->columns, tv->num_cols );
+
     *data_ptr = p;
     (*data_ptr)[*row_count] = row;
 
@@ -1758,12 +1777,7 @@ static UINT TABLE_delete_row( struct tagMSIVIEW *view, UINT row )
     num_rows = tv->table->row_count;
     tv->table->row_count--;
 
-    /* reset the hash tables */
-    for (i = 0; i < tv->num_cols; i++)
-    {
-        free(tv->columns[i].hash_table);
-        tv->columns[i].hash_table = NULL;
-    }
+    reset_hash_tables( tv->columns, tv->num_cols );
 
     for (i = row + 1; i < num_rows; i++)
     {
@@ -2165,6 +2179,74 @@ done:
     return r;
 }
 
+/* build a hash table of the values of a column, chaining the rows in ascending order */
+static UINT build_hash_table( struct table_view *tv, UINT col )
+{
+    struct column_info *column = &tv->columns[col - 1];
+    UINT i, n, size = get_hash_table_size( tv->table ), count = tv->table->row_count;
+    struct column_hash_entry **hash_table, *entry;
+
+    if (column->offset >= tv->row_size)
+    {
+        ERR("Stuffed up %d >= %d\n", column->offset, tv->row_size );
+        return ERROR_FUNCTION_FAILED;
+    }
+
+    n = bytes_per_column( tv->db, column, LONG_STR_BYTES );
+
+    /* allocate the buckets and the entries in one block so that it can be freed at once */
+    hash_table = calloc( 1, size * sizeof(*hash_table) + count * sizeof(**hash_table) );
+    if (!hash_table)
+        return ERROR_OUTOFMEMORY;
+
+    entry = (struct column_hash_entry *)(hash_table + size) + count;
+    for (i = count; i > 0; i--)
+    {
+        entry--;
+        entry->value = read_table_int( tv->table->data, i - 1, column->offset, n );
+        entry->row = i - 1;
+        entry->next = hash_table[entry->value % size];
+        hash_table[entry->value % size] = entry;
+    }
+
+    column->hash_table = hash_table;
+    return ERROR_SUCCESS;
+}
+
+static UINT TABLE_find_matching_rows( struct tagMSIVIEW *view, UINT col, UINT val, UINT *row,
+                                      MSIITERHANDLE *handle )
+{
+    struct table_view *tv = (struct table_view *)view;
+    const struct column_hash_entry *entry;
+    UINT r;
+
+    TRACE("%p, %u, %u, %p\n", view, col, val, *handle);
+
+    if (!tv->table)
+        return ERROR_INVALID_PARAMETER;
+
+    if ((col == 0) || (col > tv->num_cols))
+        return ERROR_INVALID_PARAMETER;
+
+    if (!tv->columns[col - 1].hash_table && (r = build_hash_table( tv, col )))
+        return r;
+
+    if (!*handle)
+        entry = tv->columns[col - 1].hash_table[val % get_hash_table_size( tv->table )];
+    else
+        entry = (*handle)->next;
+
+    while (entry && entry->value != val)
+        entry = entry->next;
+
+    *handle = entry;
+    if (!entry)
+        return ERROR_NO_MORE_ITEMS;
+
+    *row = entry->row;
+    return ERROR_SUCCESS;
+}
+
 static const MSIVIEWOPS table_ops =
 {
     TABLE_fetch_int,
@@ -2186,6 +2268,7 @@ static const MSIVIEWOPS table_ops =
     TABLE_add_column,
     NULL,
     TABLE_drop,
+    TABLE_find_matching_rows,
 };
 
 UINT TABLE_CreateView( MSIDATABASE *db, LPCWSTR name, MSIVIEW **view )
@@ -9406,6 +9406,126 @@ static void test_viewfetch_wraparound(void)
     DeleteFileA(msifile);
 }
 
+static UINT get_query_row_count( MSIHANDLE db, MSIHANDLE params, const char *query, const char *column,
+                                 const char *value )
+{
+    MSIHANDLE view, rec;
+    char buffer[32];
+    UINT r, count = 0;
+    DWORD size;
+
+    r = MsiDatabaseOpenViewA( db, query, &view );
+    ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+    r = MsiViewExecute( view, params );
+    ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+
+    while (!MsiViewFetch( view, &rec ))
+    {
+        if (value)
+        {
+            size = sizeof(buffer);
+            r = MsiRecordGetStringA( rec, 2, buffer, &size );
+            ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+            ok( !strcmp( buffer, value ), "%s: expected %s, got %s\n", column, value, buffer );
+        }
+        MsiCloseHandle( rec );
+        count++;
+    }
+
+    MsiViewClose( view );
+    MsiCloseHandle( view );
+    return count;
+}
+
+static void test_where_index(void)
+{
+    MSIHANDLE db, rec;
+    char buffer[32];
+    UINT r, i, count;
+
+    db = create_db();
+    ok( db, "failed to create db\n" );
+
+    r = run_query( db, 0, "CREATE TABLE `Component` ( `Component` CHAR(72) NOT NULL, "
+                   "`Attributes` SHORT PRIMARY KEY `Component`)" );
+    ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+    r = run_query( db, 0, "CREATE TABLE `File` ( `File` CHAR(72) NOT NULL, `Component_` CHAR(72), "
+                   "`Sequence` LONG PRIMARY KEY `File`)" );
+    ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+
+    rec = MsiCreateRecord( 3 );
+    for (i = 0; i < 100; i++)
+    {
+        sprintf( buffer, "c%u", i );
+        MsiRecordSetStringA( rec, 1, buffer );
+        MsiRecordSetInteger( rec, 2, (int)(i % 10) - 5 );
+        r = run_query( db, rec, "INSERT INTO `Component` ( `Component`, `Attributes` ) VALUES ( ?, ? )" );
+        ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+
+        MsiRecordSetStringA( rec, 2, buffer );
+        sprintf( buffer, "f%u_0", i );
+        MsiRecordSetStringA( rec, 1, buffer );
+        MsiRecordSetInteger( rec, 3, 2 * i );
+        r = run_query( db, rec, "INSERT INTO `File` ( `File`, `Component_`, `Sequence` ) VALUES ( ?, ?, ? )" );
+        ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+        sprintf( buffer, "f%u_1", i );
+        MsiRecordSetStringA( rec, 1, buffer );
+        MsiRecordSetInteger( rec, 3, 2 * i + 1 );
+        r = run_query( db, rec, "INSERT INTO `File` ( `File`, `Component_`, `Sequence` ) VALUES ( ?, ?, ? )" );
+        ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+    }
+    MsiCloseHandle( rec );
+
+    rec = MsiCreateRecord( 1 );
+    MsiRecordSetStringA( rec, 1, "c42" );
+    count = get_query_row_count( db, rec, "SELECT `File`, `Component_` FROM `File` WHERE `Component_` = ?",
+                                 "Component_", "c42" );
+    ok( count == 2, "got %u rows\n", count );
+
+    count = get_query_row_count( db, 0, "SELECT `File`, `Component_` FROM `File` WHERE `Component_` = 'c7'",
+                                 "Component_", "c7" );
+    ok( count == 2, "got %u rows\n", count );
+
+    count = get_query_row_count( db, 0, "SELECT `File` FROM `File` WHERE `Component_` = 'none'", NULL, NULL );
+    ok( !count, "got %u rows\n", count );
+
+    count = get_query_row_count( db, 0, "SELECT `File`, `Component_` FROM `File` WHERE `Sequence` = 151",
+                                 "Component_", "c75" );
+    ok( count == 1, "got %u rows\n", count );
+
+    count = get_query_row_count( db, 0, "SELECT `File`.`File`, `Component`.`Attributes` FROM `Component`, `File` "
+                                 "WHERE `Component`.`Component` = `File`.`Component_` AND "
+                                 "`Component`.`Attributes` = -3", "Attributes", "-3" );
+    ok( count == 20, "got %u rows\n", count );
+
+    count = get_query_row_count( db, rec, "SELECT `File`.`File`, `Component`.`Component` FROM `File`, `Component` "
+                                 "WHERE `File`.`Component_` = `Component`.`Component` AND "
+                                 "`Component`.`Component` = ?", "Component", "c42" );
+    ok( count == 2, "got %u rows\n", count );
+
+    /* the results must follow changes to the table */
+    r = run_query( db, 0, "INSERT INTO `File` ( `File`, `Component_`, `Sequence` ) VALUES ( 'extra', 'c42', 1000 )" );
+    ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+    count = get_query_row_count( db, rec, "SELECT `File`, `Component_` FROM `File` WHERE `Component_` = ?",
+                                 "Component_", "c42" );
+    ok( count == 3, "got %u rows\n", count );
+
+    r = run_query( db, 0, "DELETE FROM `File` WHERE `File` = 'f42_0'" );
+    ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+    r = run_query( db, 0, "UPDATE `File` SET `Component_` = 'c7' WHERE `File` = 'f42_1'" );
+    ok( r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r );
+    count = get_query_row_count( db, rec, "SELECT `File`, `Component_` FROM `File` WHERE `Component_` = ?",
+                                 "Component_", "c42" );
+    ok( count == 1, "got %u rows\n", count );
+    count = get_query_row_count( db, 0, "SELECT `File`, `Component_` FROM `File` WHERE `Component_` = 'c7'",
+                                 "Component_", "c7" );
+    ok( count == 3, "got %u rows\n", count );
+
+    MsiCloseHandle( rec );
+    MsiCloseHandle( db );
+    DeleteFileA( msifile );
+}
+
 START_TEST(db)
 {
     test_msidatabase();
@@ -9466,4 +9586,5 @@ START_TEST(db)
     test_viewmodify_insert();
     test_view_get_error();
     test_viewfetch_wraparound();
+    test_where_index();
 }
@@ -473,6 +473,18 @@ static const CHAR rofc_media_dat[] = "DiskId\tLastSequence\tDiskPrompt\tCabinet\
                                      "Media\tDiskId\n"
                                      "1\t1\t\ttest1.cab\tDISK1\t\n";
 
+static const CHAR fcc_file_dat[] = "File\tComponent_\tFileName\tFileSize\tVersion\tLanguage\tAttributes\tSequence\n"
+                                   "s72\ts72\tl255\ti4\tS72\tS20\tI2\ti2\n"
+                                   "File\tFile\n"
+                                   "MAXIMUS\tmaximus\taugustus\t500\t\t\t16384\t1\n"
+                                   "maximus\tmaximus\tmaximus\t500\t\t\t16384\t2";
+
+static const CHAR fcc_media_dat[] = "DiskId\tLastSequence\tDiskPrompt\tCabinet\tVolumeLabel\tSource\n"
+                                    "i2\ti4\tL64\tS255\tS32\tS72\n"
+                                    "Media\tDiskId\n"
+                                    "1\t1\t\ttest1.cab\tDISK1\t\n"
+                                    "2\t2\t\ttest2.cab\tDISK2\t\n";
+
 static const CHAR sdp_install_exec_seq_dat[] = "Action\tCondition\tSequence\n"
                                                "s72\tS255\tI2\n"
                                                "InstallExecuteSequence\tAction\n"
@@ -1672,6 +1684,18 @@ static const msi_table rofc_tables[] =
     ADD_TABLE(property),
 };
 
+static const msi_table fcc_tables[] =
+{
+    ADD_TABLE(rof_component),
+    ADD_TABLE(directory),
+    ADD_TABLE(rof_feature),
+    ADD_TABLE(rof_feature_comp),
+    ADD_TABLE(fcc_file),
+    ADD_TABLE(install_exec_seq),
+    ADD_TABLE(fcc_media),
+    ADD_TABLE(property),
+};
+
 static const msi_table sdp_tables[] =
 {
     ADD_TABLE(rof_component),
@@ -3531,6 +3555,46 @@ error:
     DeleteFileA(msifile);
 }
 
+static void test_cab_file_case(void)
+{
+    UINT r;
+
+    if (is_process_limited())
+    {
+        skip("process is limited\n");
+        return;
+    }
+
+    /* both cabinets contain a "maximus" entry, the one in test1.cab belongs to the MAXIMUS file
+     * on disk 1 while the file with the exact same key is on disk 2 */
+    CreateDirectoryA("msitest", NULL);
+    create_file("maximus", 500);
+    create_cab_file("test1.cab", MEDIA_SIZE, "maximus\0");
+    create_cab_file("test2.cab", MEDIA_SIZE, "maximus\0");
+    DeleteFileA("maximus");
+
+    create_database(msifile, fcc_tables, ARRAY_SIZE(fcc_tables));
+
+    MsiSetInternalUI(INSTALLUILEVEL_NONE, NULL);
+
+    r = MsiInstallProductA(msifile, NULL);
+    if (r == ERROR_INSTALL_PACKAGE_REJECTED)
+    {
+        skip("Not enough rights to perform tests\n");
+        goto error;
+    }
+    ok(r == ERROR_SUCCESS, "Expected ERROR_SUCCESS, got %u\n", r);
+    ok(delete_pf("msitest\\augustus", TRUE), "File not installed\n");
+    ok(delete_pf("msitest\\maximus", TRUE), "File not installed\n");
+    ok(delete_pf("msitest", FALSE), "Directory not created\n");
+
+error:
+    /* Delete the files in the temp (current) folder */
+    delete_cab_files();
+    RemoveDirectoryA("msitest");
+    DeleteFileA(msifile);
+}
+
 static void test_setdirproperty(void)
 {
     UINT r;
@@ -6333,6 +6397,7 @@ START_TEST(install)
     test_uiLevelFlags();
     test_readonlyfile();
     test_readonlyfile_cab();
+    test_cab_file_case();
     test_setdirproperty();
     test_cabisextracted();
     test_transformprop();
@@ -647,15 +647,161 @@ static UINT WHERE_evaluate( MSIWHEREVIEW *wv, const UINT rows[],
     return ERROR_SUCCESS;
 }
 
+static UINT count_wildcards( const struct expr *expr )
+{
+    switch (expr->type)
+    {
+    case EXPR_WILDCARD:
+        return 1;
+    case EXPR_COMPLEX:
+    case EXPR_STRCMP:
+        return count_wildcards( expr->u.expr.left ) + count_wildcards( expr->u.expr.right );
+    default:
+        return 0;
+    }
+}
+
+/* get the value of an expression that doesn't depend on the rows of the table being enumerated */
+static BOOL get_index_int( MSIWHEREVIEW *wv, const UINT rows[], const struct expr *expr,
+                           MSIRECORD *record, UINT rec_index, INT *val )
+{
+    struct join_table *table;
+    UINT tval;
+
+    switch (expr->type)
+    {
+    case EXPR_UVAL:
+        *val = expr->u.uval;
+        return TRUE;
+    case EXPR_WILDCARD:
+        if (!record) return FALSE;
+        *val = MSI_RecordGetInteger( record, rec_index + 1 );
+        return TRUE;
+    case EXPR_COL_NUMBER:
+    case EXPR_COL_NUMBER32:
+        table = expr->u.column.parsed.table;
+        if (rows[table->table_index] == INVALID_ROW_INDEX) return FALSE;
+        if (table->view->ops->fetch_int( table->view, rows[table->table_index],
+                                         expr->u.column.parsed.column, &tval )) return FALSE;
+        *val = tval - (expr->type == EXPR_COL_NUMBER ? 0x8000 : 0x80000000);
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+static BOOL get_index_string( MSIWHEREVIEW *wv, const UINT rows[], const struct expr *expr,
+                              MSIRECORD *record, UINT rec_index, UINT *id )
+{
+    struct join_table *table;
+    const WCHAR *str;
+
+    switch (expr->type)
+    {
+    case EXPR_SVAL:
+        str = expr->u.sval;
+        break;
+    case EXPR_WILDCARD:
+        if (!record) return FALSE;
+        str = MSI_RecordGetString( record, rec_index + 1 );
+        break;
+    case EXPR_COL_NUMBER_STRING:
+        table = expr->u.column.parsed.table;
+        if (rows[table->table_index] == INVALID_ROW_INDEX) return FALSE;
+        if (table->view->ops->fetch_int( table->view, rows[table->table_index],
+                                         expr->u.column.parsed.column, id )) return FALSE;
+        str = msi_string_lookup( wv->db->strings, *id, NULL );
+        break;
+    default:
+        return FALSE;
+    }
+
+    /* null and empty strings compare equal, they can't be looked up with a single ID */
+    if (!str || !*str) return FALSE;
+    return !msi_string2id( wv->db->strings, str, -1, id );
+}
+
+static BOOL is_table_column( const struct expr *expr, const struct join_table *table )
+{
+    switch (expr->type)
+    {
+    case EXPR_COL_NUMBER:
+    case EXPR_COL_NUMBER32:
+    case EXPR_COL_NUMBER_STRING:
+        return expr->u.column.parsed.table == table;
+    default:
+        return FALSE;
+    }
+}
+
+/* Look for an equality between a column of the table and a value that is known before
+ * its rows are enumerated, so that only the matching rows need to be checked. */
+static BOOL find_index_value( MSIWHEREVIEW *wv, const UINT rows[], const struct expr *cond,
+                              const struct join_table *table, MSIRECORD *record,
+                              UINT *rec_index, UINT *col, UINT *val )
+{
+    const struct expr *column, *value;
+    UINT index;
+    INT ival;
+
+    if (cond->type == EXPR_COMPLEX && cond->u.expr.op == OP_AND)
+    {
+        if (find_index_value( wv, rows, cond->u.expr.left, table, record, rec_index, col, val ))
+            return TRUE;
+        return find_index_value( wv, rows, cond->u.expr.right, table, record, rec_index, col, val );
+    }
+
+    /* wildcards are numbered in evaluation order */
+    index = *rec_index;
+    *rec_index += count_wildcards( cond );
+
+    if (cond->type != EXPR_COMPLEX && cond->type != EXPR_STRCMP) return FALSE;
+    if (cond->u.expr.op != OP_EQ) return FALSE;
+
+    column = cond->u.expr.left;
+    value = cond->u.expr.right;
+    if (!is_table_column( column, table ))
+    {
+        column = cond->u.expr.right;
+        value = cond->u.expr.left;
+        if (!is_table_column( column, table )) return FALSE;
+    }
+
+    if (column->type == EXPR_COL_NUMBER_STRING)
+    {
+        if (cond->type != EXPR_STRCMP) return FALSE;
+        if (!get_index_string( wv, rows, value, record, index, val )) return FALSE;
+    }
+    else
+    {
+        if (cond->type != EXPR_COMPLEX) return FALSE;
+        if (!get_index_int( wv, rows, value, record, index, &ival )) return FALSE;
+        *val = ival + (column->type == EXPR_COL_NUMBER ? 0x8000 : 0x80000000);
+    }
+
+    *col = column->u.column.parsed.column;
+    return TRUE;
+}
+
+/* get the next row to check, only going through the matching rows when an index value was found */
+static BOOL next_row( struct join_table *table, UINT col, UINT val, UINT *row, MSIITERHANDLE *handle )
+{
+    if (!col) return ++*row < table->row_count;
+    return !table->view->ops->find_matching_rows( table->view, col, val, row, handle );
+}
+
 static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, struct join_table **tables,
                              UINT table_rows[] )
 {
-    UINT r = ERROR_FUNCTION_FAILED;
+    UINT r = ERROR_SUCCESS, col = 0, value = 0, rec_index = 0;
+    MSIITERHANDLE handle = NULL;
     INT val;
 
-    for (table_rows[(*tables)->table_index] = 0;
-         table_rows[(*tables)->table_index] < (*tables)->row_count;
-         table_rows[(*tables)->table_index]++)
+    if ((*tables)->view->ops->find_matching_rows && wv->cond)
+        find_index_value( wv, table_rows, wv->cond, *tables, record, &rec_index, &col, &value );
+
+    table_rows[(*tables)->table_index] = INVALID_ROW_INDEX;
+    while (next_row( *tables, col, value, &table_rows[(*tables)->table_index], &handle ))
     {
         val = 0;
         wv->rec_index = 0;
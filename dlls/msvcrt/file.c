@@ -3674,11 +3674,21 @@ int CDECL _write(int fd, const void* buf, unsigned int count)
         }
         else if (ioinfo_get_textmode(info) == TEXTMODE_ANSI)
         {
-            for (j = 0; i < count && j < sizeof(lfbuf)-1; i++, j++)
+            while (i < count && j < sizeof(lfbuf)-1)
             {
-                if (s[i] == '\n')
+                DWORD len = min(count - i, sizeof(lfbuf) - 1 - j);
+                const char *nl = memchr(s + i, '\n', len);
+
+                if (nl) len = nl - (s + i);
+                memcpy(lfbuf + j, s + i, len);
+                i += len;
+                j += len;
+                if (nl)
+                {
                     lfbuf[j++] = '\r';
-                lfbuf[j] = s[i];
+                    lfbuf[j++] = '\n';
+                    i++;
+                }
             }
         }
         else if (ioinfo_get_textmode(info) == TEXTMODE_UTF16LE || console)
@@ -3923,11 +3933,33 @@ char * CDECL fgets(char *s, int size, FILE* file)
 
   _lock_file(file);
 
-  while ((size >1) && (cc = _fgetc_nolock(file)) != EOF && cc != '\n')
-    {
+  while (size > 1)
+  {
+      if (file->_cnt > 0)
+      {
+          /* copy as much of the line as is already buffered */
+          int len = min(file->_cnt, size - 1);
+          char *nl = memchr(file->_ptr, '\n', len);
+
+          if (nl) len = nl - file->_ptr;
+          memcpy(s, file->_ptr, len);
+          s += len;
+          size -= len;
+          file->_ptr += len;
+          file->_cnt -= len;
+          if (len) cc = (unsigned char)s[-1];
+          if (!nl) continue;
+          file->_ptr++;
+          file->_cnt--;
+          cc = '\n';
+          break;
+      }
+
+      if ((cc = _fgetc_nolock(file)) == EOF || cc == '\n')
+          break;
       *s++ = (char)cc;
       size --;
-    }
+  }
   if ((cc == EOF) && (s == buf_start)) /* If nothing read, return 0*/
   {
     TRACE(":nothing read\n");
@@ -4397,7 +4429,9 @@ int CDECL _fputc_nolock(int c, FILE* file)
   if(file->_cnt>0) {
     *file->_ptr++=c;
     file->_cnt--;
-    if (c == '\n')
+    /* only flush lines that somebody may be waiting for, regular files
+     * are written once the buffer is full */
+    if (c == '\n' && get_ioinfo_nolock(file->_file)->wxflag & (WX_TTY | WX_PIPE))
     {
       res = msvcrt_flush_buffer(file);
       return res ? res : c;
@@ -149,6 +149,156 @@ static inline unsigned int log10i(unsigned int x)
     return t - (x < p10s[t]);
 }
 
+/* Normalized approximations of 10^k, k = -348, -340, ..., 340 */
+static const struct
+{
+    ULONGLONG f;
+    short e;
+    short k;
+} cached_pow10[] =
+{
+    { 0xfa8fd5a0081c0288ULL, -1220, -348 }, { 0xbaaee17fa23ebf76ULL, -1193, -340 },
+    { 0x8b16fb203055ac76ULL, -1166, -332 }, { 0xcf42894a5dce35eaULL, -1140, -324 },
+    { 0x9a6bb0aa55653b2dULL, -1113, -316 }, { 0xe61acf033d1a45dfULL, -1087, -308 },
+    { 0xab70fe17c79ac6caULL, -1060, -300 }, { 0xff77b1fcbebcdc4fULL, -1034, -292 },
+    { 0xbe5691ef416bd60cULL, -1007, -284 }, { 0x8dd01fad907ffc3cULL,  -980, -276 },
+    { 0xd3515c2831559a83ULL,  -954, -268 }, { 0x9d71ac8fada6c9b5ULL,  -927, -260 },
+    { 0xea9c227723ee8bcbULL,  -901, -252 }, { 0xaecc49914078536dULL,  -874, -244 },
+    { 0x823c12795db6ce57ULL,  -847, -236 }, { 0xc21094364dfb5637ULL,  -821, -228 },
+    { 0x9096ea6f3848984fULL,  -794, -220 }, { 0xd77485cb25823ac7ULL,  -768, -212 },
+    { 0xa086cfcd97bf97f4ULL,  -741, -204 }, { 0xef340a98172aace5ULL,  -715, -196 },
+    { 0xb23867fb2a35b28eULL,  -688, -188 }, { 0x84c8d4dfd2c63f3bULL,  -661, -180 },
+    { 0xc5dd44271ad3cdbaULL,  -635, -172 }, { 0x936b9fcebb25c996ULL,  -608, -164 },
+    { 0xdbac6c247d62a584ULL,  -582, -156 }, { 0xa3ab66580d5fdaf6ULL,  -555, -148 },
+    { 0xf3e2f893dec3f126ULL,  -529, -140 }, { 0xb5b5ada8aaff80b8ULL,  -502, -132 },
+    { 0x87625f056c7c4a8bULL,  -475, -124 }, { 0xc9bcff6034c13053ULL,  -449, -116 },
+    { 0x964e858c91ba2655ULL,  -422, -108 }, { 0xdff9772470297ebdULL,  -396, -100 },
+    { 0xa6dfbd9fb8e5b88fULL,  -369,  -92 }, { 0xf8a95fcf88747d94ULL,  -343,  -84 },
+    { 0xb94470938fa89bcfULL,  -316,  -76 }, { 0x8a08f0f8bf0f156bULL,  -289,  -68 },
+    { 0xcdb02555653131b6ULL,  -263,  -60 }, { 0x993fe2c6d07b7facULL,  -236,  -52 },
+    { 0xe45c10c42a2b3b06ULL,  -210,  -44 }, { 0xaa242499697392d3ULL,  -183,  -36 },
+    { 0xfd87b5f28300ca0eULL,  -157,  -28 }, { 0xbce5086492111aebULL,  -130,  -20 },
+    { 0x8cbccc096f5088ccULL,  -103,  -12 }, { 0xd1b71758e219652cULL,   -77,   -4 },
+    { 0x9c40000000000000ULL,   -50,    4 }, { 0xe8d4a51000000000ULL,   -24,   12 },
+    { 0xad78ebc5ac620000ULL,     3,   20 }, { 0x813f3978f8940984ULL,    30,   28 },
+    { 0xc097ce7bc90715b3ULL,    56,   36 }, { 0x8f7e32ce7bea5c70ULL,    83,   44 },
+    { 0xd5d238a4abe98068ULL,   109,   52 }, { 0x9f4f2726179a2245ULL,   136,   60 },
+    { 0xed63a231d4c4fb27ULL,   162,   68 }, { 0xb0de65388cc8ada8ULL,   189,   76 },
+    { 0x83c7088e1aab65dbULL,   216,   84 }, { 0xc45d1df942711d9aULL,   242,   92 },
+    { 0x924d692ca61be758ULL,   269,  100 }, { 0xda01ee641a708deaULL,   295,  108 },
+    { 0xa26da3999aef774aULL,   322,  116 }, { 0xf209787bb47d6b85ULL,   348,  124 },
+    { 0xb454e4a179dd1877ULL,   375,  132 }, { 0x865b86925b9bc5c2ULL,   402,  140 },
+    { 0xc83553c5c8965d3dULL,   428,  148 }, { 0x952ab45cfa97a0b3ULL,   455,  156 },
+    { 0xde469fbd99a05fe3ULL,   481,  164 }, { 0xa59bc234db398c25ULL,   508,  172 },
+    { 0xf6c69a72a3989f5cULL,   534,  180 }, { 0xb7dcbf5354e9beceULL,   561,  188 },
+    { 0x88fcf317f22241e2ULL,   588,  196 }, { 0xcc20ce9bd35c78a5ULL,   614,  204 },
+    { 0x98165af37b2153dfULL,   641,  212 }, { 0xe2a0b5dc971f303aULL,   667,  220 },
+    { 0xa8d9d1535ce3b396ULL,   694,  228 }, { 0xfb9b7cd9a4a7443cULL,   720,  236 },
+    { 0xbb764c4ca7a44410ULL,   747,  244 }, { 0x8bab8eefb6409c1aULL,   774,  252 },
+    { 0xd01fef10a657842cULL,   800,  260 }, { 0x9b10a4e5e9913129ULL,   827,  268 },
+    { 0xe7109bfba19c0c9dULL,   853,  276 }, { 0xac2820d9623bf429ULL,   880,  284 },
+    { 0x80444b5e7aa7cf85ULL,   907,  292 }, { 0xbf21e44003acdd2dULL,   933,  300 },
+    { 0x8e679c2f5e44ff8fULL,   960,  308 }, { 0xd433179d9c8cb841ULL,   986,  316 },
+    { 0x9e19db92b4e31ba9ULL,  1013,  324 }, { 0xeb96bf6ebadf77d9ULL,  1039,  332 },
+    { 0xaf87023b9bf0ee6bULL,  1066,  340 },
+};
+
+/* Returns upper 64 bits of x*y, rounded */
+static inline ULONGLONG mul_hi64(ULONGLONG x, ULONGLONG y)
+{
+    ULONGLONG a = x >> 32, b = (DWORD)x, c = y >> 32, d = (DWORD)y;
+    ULONGLONG ac = a * c, bc = b * c, ad = a * d, bd = b * d, tmp;
+
+    tmp = (bd >> 32) + (DWORD)ad + (DWORD)bc + (1u << 31);
+    return ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+}
+
+/* Rounds m*2^e (m has MANT_BITS significant bits) to the number of digits needed by
+ * the format using 64-bit arithmetic (Grisu digit generation). The result is stored
+ * as digits*10^exp10. Returns FALSE if the rounding direction can't be decided, the
+ * caller needs to use exact arithmetic in that case. */
+static inline BOOL fast_fp_digits(ULONGLONG m, int e, char format, int prec,
+        ULONGLONG *digits, int *exp10)
+{
+    ULONGLONG w, f, one, frac, rest, unit = 1, ten_kappa, d = 0;
+    int i, k, n, kappa, count, shift;
+    DWORD integrals, divisor;
+
+    w = m << (64 - MANT_BITS);
+    e -= 64 - MANT_BITS;
+
+    /* Find 10^k that puts the binary exponent of w*10^k into [-60, -32] range. */
+    k = -60 - e - 1;
+    k = (k * 30103 + (k > 0 ? 99999 : 0)) / 100000;
+    i = (k + 348 + 7) / 8;
+    if (i < 0) i = 0;
+    if (i >= ARRAY_SIZE(cached_pow10)) i = ARRAY_SIZE(cached_pow10) - 1;
+    while (i > 0 && e + cached_pow10[i].e + 64 > -32) i--;
+    while (i < ARRAY_SIZE(cached_pow10) - 1 && e + cached_pow10[i].e + 64 < -60) i++;
+    shift = -(e + cached_pow10[i].e + 64);
+    if (shift < 32 || shift > 60) return FALSE;
+    k = cached_pow10[i].k;
+
+    f = mul_hi64(w, cached_pow10[i].f);
+    one = (ULONGLONG)1 << shift;
+    integrals = f >> shift;
+    frac = f & (one - 1);
+
+    n = log10i(integrals) + 1;
+    divisor = p10s[n - 1];
+    if (format == 'f' || format == 'F')
+        count = prec + n - k;
+    else if (format == 'e' || format == 'E')
+        count = prec + 1;
+    else
+        count = prec ? prec : 1;
+    if (count <= 0 || count > 17) return FALSE;
+
+    for (kappa = n; kappa > 0;)
+    {
+        d = d * 10 + integrals / divisor;
+        integrals %= divisor;
+        kappa--;
+        if (!--count) break;
+        divisor /= 10;
+    }
+
+    if (!count)
+    {
+        rest = ((ULONGLONG)integrals << shift) + frac;
+        ten_kappa = (ULONGLONG)divisor << shift;
+    }
+    else
+    {
+        /* Scaled value is only accurate to 1 unit, error grows with every digit. */
+        while (count && frac > unit)
+        {
+            frac *= 10;
+            unit *= 10;
+            d = d * 10 + (frac >> shift);
+            frac &= one - 1;
+            kappa--;
+            count--;
+        }
+        if (count) return FALSE;
+        rest = frac;
+        ten_kappa = one;
+    }
+
+    if (unit >= ten_kappa || ten_kappa - unit <= unit)
+        return FALSE;
+    if (ten_kappa - rest > rest && ten_kappa - 2 * rest >= 2 * unit)
+        ; /* round down */
+    else if (rest > unit && ten_kappa - (rest - unit) <= rest - unit)
+        d++;
+    else
+        return FALSE;
+
+    *digits = d;
+    *exp10 = kappa - k;
+    return TRUE;
+}
+
 #endif
 
 static inline int FUNC_NAME(pf_output_wstr)(FUNC_NAME(puts_clbk) pf_puts, void *puts_ctx,
@@ -621,12 +771,29 @@ static inline int FUNC_NAME(pf_output_fp)(FUNC_NAME(puts_clbk) pf_puts, void *pu
     if(v) {
         m = (ULONGLONG)1 << (MANT_BITS - 1);
         m |= (*(ULONGLONG*)&v & (((ULONGLONG)1 << (MANT_BITS - 1)) - 1));
-        b->b = 0;
-        b->e = 2;
-        b->size = BNUM_PREC64;
-        b->data[0] = m % LIMB_MAX;
-        b->data[1] = m / LIMB_MAX;
         e2 -= MANT_BITS;
+        b->size = BNUM_PREC64;
+
+        if(fast_fp_digits(m, e2, flags->Format, flags->Precision, &m, &e10)) {
+            /* m*10^e10 is already rounded to the printed precision, store it with
+             * decimal point on limb boundary. */
+            i = e10 % LIMB_DIGITS;
+            if(i < 0) i += LIMB_DIGITS;
+            e10 = (e10 - i) / LIMB_DIGITS;
+
+            b->b = 0;
+            b->data[0] = m % LIMB_MAX;
+            b->data[1] = m / LIMB_MAX;
+            b->e = b->data[1] ? 2 : 1;
+            bnum_mult(b, p10s[i]);
+            e10 = (e10 + b->e - 2) * LIMB_DIGITS;
+            e2 = 0;
+        } else {
+            b->b = 0;
+            b->e = 2;
+            b->data[0] = m % LIMB_MAX;
+            b->data[1] = m / LIMB_MAX;
+        }
 
         while(e2 > 0) {
             int shift = e2 > 29 ? 29 : e2;
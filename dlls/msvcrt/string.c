@@ -742,6 +742,72 @@ static inline BOOL bnum_to_mant(struct bnum *b, ULONGLONG *m)
     return TRUE;
 }
 
+static inline int bit_length(ULONGLONG x)
+{
+    ULONG idx;
+
+    if(x >> 32) {
+        _BitScanReverse(&idx, x >> 32);
+        return idx + 33;
+    }
+    if(!x) return 0;
+    _BitScanReverse(&idx, x);
+    return idx + 1;
+}
+
+/* Handles numbers with up to 19 significant digits and small exponents without
+ * big number arithmetic. Value is m*10^e10, it's converted to binary using 64-bit
+ * integer multiplication or division by power of 5. */
+static BOOL fpnum_parse_fast(struct bnum *b, int limb_digits, int dp, int sign, struct fpnum *ret)
+{
+    ULONGLONG m = 0, p5, q, r;
+    enum fpmod round;
+    int i, digits, e10, e2, step;
+
+    digits = (b->e - 1 - b->b) * LIMB_DIGITS + limb_digits;
+    if(digits > 19) return FALSE;
+    for(i = b->e - 1; i > b->b; i--)
+        m = m * LIMB_MAX + b->data[bnum_idx(b, i)];
+    m = m * p10s[limb_digits] + b->data[bnum_idx(b, b->b)];
+    e10 = dp - digits;
+
+    if(e10 >= 0) {
+        /* m*10^e10 = m*5^e10*2^e10, exact if m*5^e10 fits in 64 bits */
+        for(i = 0; i < e10; i++) {
+            if(m > UI64_MAX / 5) return FALSE;
+            m *= 5;
+        }
+        *ret = fpnum(sign, e10, m, FP_ROUND_ZERO);
+        return TRUE;
+    }
+
+    /* Remainder needs to be shifted by at least 1 bit without overflow. */
+    if(e10 < -26) return FALSE;
+    for(p5 = 1, i = 0; i < -e10; i++)
+        p5 *= 5;
+    step = 64 - bit_length(p5);
+
+    /* Long division m/5^-e10 until quotient has 64 significant bits. */
+    q = m / p5;
+    r = m % p5;
+    e2 = e10;
+    while(!(q >> 63)) {
+        i = 64 - bit_length(q);
+        if(i > step) i = step;
+        r <<= i;
+        q = (q << i) | (r / p5);
+        r %= p5;
+        e2 -= i;
+    }
+
+    if(!r) round = FP_ROUND_ZERO;
+    else if(r > p5 - r) round = FP_ROUND_UP;
+    else if(r == p5 - r) round = FP_ROUND_EVEN;
+    else round = FP_ROUND_DOWN;
+    *ret = fpnum(sign, e2, q, round);
+    return TRUE;
+}
+
 static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(void *ctx),
         void *ctx, pthreadlocinfo locinfo, BOOL ldouble, struct bnum *b)
 {
@@ -754,6 +820,7 @@ static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(vo
     BOOL found_digit = FALSE, found_dp = FALSE, found_sign = FALSE;
     int e2 = 0, dp=0, sign=1, off, limb_digits = 0, i;
     enum fpmod round = FP_ROUND_ZERO;
+    struct fpnum ret;
     wchar_t nch;
     ULONGLONG m;
 
@@ -917,6 +984,10 @@ static struct fpnum fpnum_parse_bnum(wchar_t (*get)(void *ctx), void (*unget)(vo
     if(!b->data[bnum_idx(b, b->e-1)])
         return fpnum(sign, 0, 0, 0);
 
+    if(b->e - b->b <= 3 && dp > -LIMB_DIGITS*3 && dp < LIMB_DIGITS*3 &&
+            fpnum_parse_fast(b, limb_digits, dp, sign, &ret))
+        return ret;
+
     /* Fill last limb with 0 if needed */
     if(b->b+1 != b->e) {
         for(; limb_digits != LIMB_DIGITS; limb_digits++)
@@ -1559,13 +1630,28 @@ int CDECL _atoldbl(_LDOUBLE *value, char *str)
     return _atoldbl_l( (MSVCRT__LDOUBLE*)value, str, NULL );
 }
 
+/* Word at a time helpers. Only aligned words are read, so reading past the end of
+ * the string never crosses a page boundary. */
+#define WORD_ONES  ((size_t)~0 / 0xff)
+#define WORD_HIGHS (WORD_ONES * 0x80)
+
+static inline size_t word_has_zero(size_t w)
+{
+    return (w - WORD_ONES) & ~w & WORD_HIGHS;
+}
+
 /*********************************************************************
  *              strlen (MSVCRT.@)
  */
 size_t __cdecl strlen(const char *str)
 {
     const char *s = str;
-    while (*s) s++;
+    const size_t *w;
+
+    for (; (uintptr_t)s & (sizeof(size_t) - 1); s++)
+        if (!*s) return s - str;
+    for (w = (const size_t *)s; !word_has_zero(*w); w++);
+    for (s = (const char *)w; *s; s++);
     return s - str;
 }
 
@@ -3248,6 +3334,17 @@ void *__cdecl memset(void *dst, int c, size_t n)
  */
 char* __cdecl strchr(const char *str, int c)
 {
+    size_t v = WORD_ONES * (unsigned char)c;
+    const size_t *w;
+
+    for (; (uintptr_t)str & (sizeof(size_t) - 1); str++)
+    {
+        if (*str == (char)c) return (char*)str;
+        if (!*str) return NULL;
+    }
+    for (w = (const size_t *)str; !word_has_zero(*w) && !word_has_zero(*w ^ v); w++);
+
+    str = (const char *)w;
     do
     {
         if (*str == (char)c) return (char*)str;
@@ -3270,9 +3367,14 @@ char* __cdecl strrchr(const char *str, int c)
  */
 void* __cdecl memchr(const void *ptr, int c, size_t n)
 {
+    size_t v = WORD_ONES * (unsigned char)c;
     const unsigned char *p = ptr;
 
-    for (p = ptr; n; n--, p++) if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
+    for (; n && (uintptr_t)p & (sizeof(size_t) - 1); n--, p++)
+        if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
+    for (; n >= sizeof(size_t); n -= sizeof(size_t), p += sizeof(size_t))
+        if (word_has_zero(*(const size_t *)p ^ v)) break;
+    for (; n; n--, p++) if (*p == (unsigned char)c) return (void *)(ULONG_PTR)p;
     return NULL;
 }
 
@@ -3281,6 +3383,21 @@ void* __cdecl memchr(const void *ptr, int c, size_t n)
  */
 int __cdecl strcmp(const char *str1, const char *str2)
 {
+    if (!(((uintptr_t)str1 ^ (uintptr_t)str2) & (sizeof(size_t) - 1)))
+    {
+        const size_t *w1, *w2;
+
+        for (; (uintptr_t)str1 & (sizeof(size_t) - 1); str1++, str2++)
+            if (!*str1 || *str1 != *str2) break;
+        if (!((uintptr_t)str1 & (sizeof(size_t) - 1)))
+        {
+            for (w1 = (const size_t *)str1, w2 = (const size_t *)str2;
+                 *w1 == *w2 && !word_has_zero(*w1); w1++, w2++);
+            str1 = (const char *)w1;
+            str2 = (const char *)w2;
+        }
+    }
+
     while (*str1 && *str1 == *str2) { str1++; str2++; }
     if ((unsigned char)*str1 > (unsigned char)*str2) return 1;
     if ((unsigned char)*str1 < (unsigned char)*str2) return -1;
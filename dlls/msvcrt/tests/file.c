@@ -680,6 +680,10 @@ static void test_fputc( void )
   ok(0xff == ret, "fputc(0xff,tempfh) expected %x got %x\n", 0xff, ret);
   ret = fputc(0xffffffff,tempfh);
   ok(0xff == ret, "fputc(0xffffffff,tempfh) expected %x got %x\n", 0xff, ret);
+  ret = fputc('\n',tempfh);
+  ok('\n' == ret, "fputc('\\n',tempfh) expected %x got %x\n", '\n', ret);
+  ok(tempfh->_ptr - tempfh->_base == 4, "newline flushed the buffer, %d bytes buffered\n",
+     (int)(tempfh->_ptr - tempfh->_base));
   fclose(tempfh);
 
   tempfh = fopen(tempf,"rb");
@@ -60,6 +60,11 @@ static int (__cdecl *p_memcpy_s)(void *, size_t, const void *, size_t);
 static int (__cdecl *p_memmove_s)(void *, size_t, const void *, size_t);
 static int* (__cdecl *pmemcmp)(void *, const void *, size_t n);
 static int (__cdecl *p_strcmp)(const char *, const char *);
+static size_t (__cdecl *p_strlen)(const char *);
+static char* (__cdecl *p_strchr)(const char *, int);
+static void* (__cdecl *p_memchr)(const void *, int, size_t);
+static size_t (__cdecl *p_wcslen)(const wchar_t *);
+static int (__cdecl *p_wcscmp)(const wchar_t *, const wchar_t *);
 static int (__cdecl *p_strncmp)(const char *, const char *, size_t);
 static int (__cdecl *p_strcpy)(char *dst, const char *src);
 static int (__cdecl *pstrcpy_s)(char *dst, size_t len, const char *src);
@@ -4082,6 +4087,89 @@ static void test__memicmp_l(void)
     ok(errno == 0xdeadbeef, "errno is %d, expected 0xdeadbeef\n", errno);
 }
 
+static void test_page_boundary(void)
+{
+    char *mem, *str, copy[64];
+    wchar_t *wstr, wcopy[64];
+    unsigned int len, align;
+    SYSTEM_INFO si;
+    DWORD prot;
+    void *p;
+    int ret;
+
+    GetSystemInfo(&si);
+    mem = VirtualAlloc(NULL, 2 * si.dwPageSize, MEM_COMMIT, PAGE_READWRITE);
+    ok(mem != NULL, "VirtualAlloc failed\n");
+    ok(VirtualProtect(mem + si.dwPageSize, si.dwPageSize, PAGE_NOACCESS, &prot), "VirtualProtect failed\n");
+
+    /* Strings end at most align characters before an inaccessible page,
+     * with non-zero bytes in between. */
+    for (len = 0; len < 40; len++)
+    {
+        for (align = 0; align < 16; align++)
+        {
+            str = mem + si.dwPageSize - len - 1 - align;
+            memset(str, 'a' + align, len);
+            str[len] = 0;
+            memset(str + len + 1, 'z', align);
+            memcpy(copy + align, str, len + 1);
+
+            ok(p_strlen(str) == len, "%u,%u) strlen returned %Iu\n", len, align, p_strlen(str));
+            p = p_strchr(str, 'z');
+            ok(!p, "%u,%u) strchr returned %p\n", len, align, p);
+            p = p_strchr(str, 0);
+            ok(p == str + len, "%u,%u) strchr returned %p, expected %p\n", len, align, p, str + len);
+            p = p_memchr(str, 0, len + 1);
+            ok(p == str + len, "%u,%u) memchr returned %p, expected %p\n", len, align, p, str + len);
+            ret = p_strcmp(str, copy + align);
+            ok(!ret, "%u,%u) strcmp returned %d\n", len, align, ret);
+            if (len)
+            {
+                copy[align + len - 1]++;
+                ret = p_strcmp(str, copy + align);
+                ok(ret == -1, "%u,%u) strcmp returned %d\n", len, align, ret);
+            }
+
+            wstr = (wchar_t *)(mem + si.dwPageSize) - len - 1 - align;
+            wmemset(wstr, 'a' + align, len);
+            wstr[len] = 0;
+            wmemset(wstr + len + 1, 'z', align);
+            memcpy(wcopy + align, wstr, (len + 1) * sizeof(wchar_t));
+
+            ok(p_wcslen(wstr) == len, "%u,%u) wcslen returned %Iu\n", len, align, p_wcslen(wstr));
+            ret = p_wcscmp(wstr, wcopy + align);
+            ok(!ret, "%u,%u) wcscmp returned %d\n", len, align, ret);
+            if (len)
+            {
+                wcopy[align + len - 1]--;
+                ret = p_wcscmp(wstr, wcopy + align);
+                ok(ret == 1, "%u,%u) wcscmp returned %d\n", len, align, ret);
+            }
+        }
+    }
+
+    /* The searched character is the last one before an inaccessible page. */
+    for (len = 1; len < 40; len++)
+    {
+        str = mem + si.dwPageSize - len;
+        memset(str, 'a', len - 1);
+        str[len - 1] = 'z';
+        p = p_memchr(str, 'z', len);
+        ok(p == str + len - 1, "%u) memchr returned %p, expected %p\n", len, p, str + len - 1);
+        p = p_memchr(str, 'y', len);
+        ok(!p, "%u) memchr returned %p\n", len, p);
+
+        str = mem + si.dwPageSize - len - 1;
+        memset(str, 'a', len - 1);
+        str[len - 1] = 'z';
+        str[len] = 0;
+        p = p_strchr(str, 'z');
+        ok(p == str + len - 1, "%u) strchr returned %p, expected %p\n", len, p, str + len - 1);
+    }
+
+    VirtualFree(mem, 0, MEM_RELEASE);
+}
+
 static void test__strupr(void)
 {
     const char str[] = "123";
@@ -4710,6 +4798,11 @@ START_TEST(string)
     SET(p__mb_cur_max,"__mb_cur_max");
     SET(p_strcpy, "strcpy");
     SET(p_strcmp, "strcmp");
+    SET(p_strlen, "strlen");
+    SET(p_strchr, "strchr");
+    SET(p_memchr, "memchr");
+    SET(p_wcslen, "wcslen");
+    SET(p_wcscmp, "wcscmp");
     SET(p_strncmp, "strncmp");
     pstrcpy_s = (void *)GetProcAddress( hMsvcrt,"strcpy_s" );
     pstrcat_s = (void *)GetProcAddress( hMsvcrt,"strcat_s" );
@@ -4853,4 +4946,5 @@ START_TEST(string)
     test__mbbtype();
     test_wcsncpy();
     test_mbsrev();
+    test_page_boundary();
 }
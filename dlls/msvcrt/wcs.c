@@ -33,6 +33,16 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(msvcrt);
 
+/* Checks for a zero wchar_t in an aligned word, only aligned words are read so
+ * reading past the end of the string never crosses a page boundary. */
+#define WCHAR_WORD_ONES  ((size_t)~0 / 0xffff)
+#define WCHAR_WORD_HIGHS (WCHAR_WORD_ONES * 0x8000)
+
+static inline size_t word_has_zero_wchar(size_t w)
+{
+    return (w - WCHAR_WORD_ONES) & ~w & WCHAR_WORD_HIGHS;
+}
+
 typedef struct
 {
     enum { LEN_DEFAULT, LEN_SHORT, LEN_LONG } IntegerLength;
@@ -1967,6 +1977,21 @@ int WINAPIV _swprintf_p_l(wchar_t *buffer, size_t length,
  */
 int CDECL wcscmp(const wchar_t *str1, const wchar_t *str2)
 {
+    if (!(((uintptr_t)str1 ^ (uintptr_t)str2) & (sizeof(size_t) - 1)) && !((uintptr_t)str1 & 1))
+    {
+        const size_t *w1, *w2;
+
+        for (; (uintptr_t)str1 & (sizeof(size_t) - 1); str1++, str2++)
+            if (!*str1 || *str1 != *str2) break;
+        if (!((uintptr_t)str1 & (sizeof(size_t) - 1)))
+        {
+            for (w1 = (const size_t *)str1, w2 = (const size_t *)str2;
+                 *w1 == *w2 && !word_has_zero_wchar(*w1); w1++, w2++);
+            str1 = (const wchar_t *)w1;
+            str2 = (const wchar_t *)w2;
+        }
+    }
+
     while (*str1 && (*str1 == *str2))
     {
         str1++;
@@ -2969,6 +2994,15 @@ wchar_t* CDECL wcsrchr(const wchar_t *str, wchar_t ch)
 size_t CDECL wcslen(const wchar_t *str)
 {
     const wchar_t *s = str;
+    const size_t *w;
+
+    if (!((uintptr_t)s & 1))
+    {
+        for (; (uintptr_t)s & (sizeof(size_t) - 1); s++)
+            if (!*s) return s - str;
+        for (w = (const size_t *)s; !word_has_zero_wchar(*w); w++);
+        s = (const wchar_t *)w;
+    }
     while (*s) s++;
     return s - str;
 }
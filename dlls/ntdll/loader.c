@@ -138,8 +138,11 @@ typedef struct _wine_modref
 {
     LDR_DATA_TABLE_ENTRY  ldr;
     struct file_id        id;
+    LIST_ENTRY            id_links;       /* entry in fileid_hash_table */
     ULONG                 CheckSum;
     BOOL                  system;
+    DWORD                *export_hash;    /* export name index + 1, built on demand */
+    ULONG                 export_hash_mask;
 } WINE_MODREF;
 
 typedef struct
@@ -194,6 +197,13 @@ static PEB_LDR_DATA ldr =
 static RTL_BITMAP tls_bitmap;
 static RTL_BITMAP tls_expansion_bitmap;
 
+#define HASH_MAP_SIZE 32
+static LIST_ENTRY hash_table[HASH_MAP_SIZE];         /* modules by base name, linked through HashLinks */
+static LIST_ENTRY fileid_hash_table[HASH_MAP_SIZE];  /* modules by file id */
+
+/* modules with fewer exported names are simply binary searched */
+#define EXPORT_HASH_MIN_NAMES 64
+
 static WINE_MODREF *cached_modref;
 static WINE_MODREF *current_modref;
 static WINE_MODREF *last_failed_modref;
@@ -204,7 +214,7 @@ static NTSTATUS load_dll( const WCHAR *load_path, const WCHAR *libname, DWORD fl
 static NTSTATUS process_attach( LDR_DDAG_NODE *node, LPVOID lpReserved );
 static FARPROC find_ordinal_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports,
                                     DWORD exp_size, DWORD ordinal, LPCWSTR load_path );
-static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports,
+static FARPROC find_named_export( WINE_MODREF *wm, const IMAGE_EXPORT_DIRECTORY *exports,
                                   DWORD exp_size, const char *name, int hint, LPCWSTR load_path );
 
 /* convert PE image VirtualAddress to Real Address */
@@ -582,6 +592,34 @@ static WINE_MODREF *get_modref( HMODULE hmod )
 }
 
 
+/**********************************************************************
+ *	    hash_basename
+ *
+ * Compute the hash of a module base name.
+ */
+static ULONG hash_basename( const UNICODE_STRING *basename )
+{
+    ULONG hash = 0;
+
+    RtlHashUnicodeString( basename, TRUE, HASH_STRING_ALGORITHM_X65599, &hash );
+    return hash;
+}
+
+
+/**********************************************************************
+ *	    hash_file_id
+ *
+ * Compute the fileid_hash_table bucket of a file id.
+ */
+static ULONG hash_file_id( const struct file_id *id )
+{
+    ULONG i, hash = 0;
+
+    for (i = 0; i < sizeof(id->ObjectId); i++) hash = hash * 31 + id->ObjectId[i];
+    return hash % HASH_MAP_SIZE;
+}
+
+
 /**********************************************************************
  *	    find_basename_module
  *
@@ -598,10 +636,10 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
     if (cached_modref && RtlEqualUnicodeString( &name_str, &cached_modref->ldr.BaseDllName, TRUE ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
+    mark = &hash_table[hash_basename( &name_str ) % HASH_MAP_SIZE];
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
-        WINE_MODREF *mod = CONTAINING_RECORD(entry, WINE_MODREF, ldr.InLoadOrderLinks);
+        WINE_MODREF *mod = CONTAINING_RECORD(entry, WINE_MODREF, ldr.HashLinks);
         if (RtlEqualUnicodeString( &name_str, &mod->ldr.BaseDllName, TRUE ) && !mod->system)
         {
             cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
@@ -621,7 +659,8 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
 static WINE_MODREF *find_fullname_module( const UNICODE_STRING *nt_name )
 {
     PLIST_ENTRY mark, entry;
-    UNICODE_STRING name = *nt_name;
+    UNICODE_STRING name = *nt_name, basename;
+    USHORT i;
 
     if (name.Length <= 4 * sizeof(WCHAR)) return NULL;
     name.Length -= 4 * sizeof(WCHAR);  /* for \??\ prefix */
@@ -630,10 +669,15 @@ static WINE_MODREF *find_fullname_module( const UNICODE_STRING *nt_name )
     if (cached_modref && RtlEqualUnicodeString( &name, &cached_modref->ldr.FullDllName, TRUE ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
+    /* the base name is the last path element, see alloc_module */
+    for (i = name.Length / sizeof(WCHAR); i > 0; i--) if (name.Buffer[i - 1] == '\\') break;
+    basename.Buffer = name.Buffer + i;
+    basename.Length = basename.MaximumLength = name.Length - i * sizeof(WCHAR);
+
+    mark = &hash_table[hash_basename( &basename ) % HASH_MAP_SIZE];
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
-        LDR_DATA_TABLE_ENTRY *mod = CONTAINING_RECORD(entry, LDR_DATA_TABLE_ENTRY, InLoadOrderLinks);
+        LDR_DATA_TABLE_ENTRY *mod = CONTAINING_RECORD(entry, LDR_DATA_TABLE_ENTRY, HashLinks);
         if (RtlEqualUnicodeString( &name, &mod->FullDllName, TRUE ))
         {
             cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
@@ -656,11 +700,10 @@ static WINE_MODREF *find_fileid_module( const struct file_id *id )
 
     if (cached_modref && !memcmp( &cached_modref->id, id, sizeof(*id) )) return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
+    mark = &fileid_hash_table[hash_file_id( id )];
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
-        LDR_DATA_TABLE_ENTRY *mod = CONTAINING_RECORD( entry, LDR_DATA_TABLE_ENTRY, InLoadOrderLinks );
-        WINE_MODREF *wm = CONTAINING_RECORD( mod, WINE_MODREF, ldr );
+        WINE_MODREF *wm = CONTAINING_RECORD( entry, WINE_MODREF, id_links );
 
         if (!memcmp( &wm->id, id, sizeof(*id) ))
         {
@@ -962,7 +1005,7 @@ static FARPROC find_forwarded_export( HMODULE module, const char *forward, LPCWS
             proc = find_ordinal_export( wm->ldr.DllBase, exports, exp_size,
                                         atoi(name+1) - exports->Base, load_path );
         } else
-            proc = find_named_export( wm->ldr.DllBase, exports, exp_size, name, -1, load_path );
+            proc = find_named_export( wm, exports, exp_size, name, -1, load_path );
     }
 
     if (!proc)
@@ -1040,15 +1083,72 @@ static int find_name_in_exports( HMODULE module, const IMAGE_EXPORT_DIRECTORY *e
 }
 
 
+/*************************************************************************
+ *		hash_export_name
+ */
+static ULONG hash_export_name( const char *name )
+{
+    ULONG hash = 2166136261u;
+
+    while (*name) hash = (hash ^ (unsigned char)*name++) * 16777619;
+    return hash;
+}
+
+
+/*************************************************************************
+ *		find_hashed_export
+ *
+ * Helper for find_named_export. Looks the name up in the module export
+ * hash table, building it on first use.
+ * Returns -1 if the name is not found, -2 if the table can't be used.
+ */
+static int find_hashed_export( WINE_MODREF *wm, const IMAGE_EXPORT_DIRECTORY *exports, const char *name )
+{
+    HMODULE module = wm->ldr.DllBase;
+    const WORD *ordinals = get_rva( module, exports->AddressOfNameOrdinals );
+    const DWORD *names = get_rva( module, exports->AddressOfNames );
+    ULONG i, pos, size;
+
+    if (exports->NumberOfNames < EXPORT_HASH_MIN_NAMES) return -2;
+
+    if (!wm->export_hash)
+    {
+        if (exports->NumberOfNames > 0x1000000) return -2;
+        size = EXPORT_HASH_MIN_NAMES;
+        while (size < 2 * exports->NumberOfNames) size *= 2;
+        if (!(wm->export_hash = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY,
+                                                 size * sizeof(*wm->export_hash) )))
+            return -2;
+        wm->export_hash_mask = size - 1;
+        for (i = 0; i < exports->NumberOfNames; i++)
+        {
+            pos = hash_export_name( get_rva( module, names[i] )) & wm->export_hash_mask;
+            while (wm->export_hash[pos]) pos = (pos + 1) & wm->export_hash_mask;
+            wm->export_hash[pos] = i + 1;
+        }
+        TRACE( "built export hash of %lu entries for %s\n", size, debugstr_w(wm->ldr.BaseDllName.Buffer) );
+    }
+
+    pos = hash_export_name( name ) & wm->export_hash_mask;
+    while ((i = wm->export_hash[pos]))
+    {
+        if (!strcmp( get_rva( module, names[i - 1] ), name )) return ordinals[i - 1];
+        pos = (pos + 1) & wm->export_hash_mask;
+    }
+    return -1;
+}
+
+
 /*************************************************************************
  *		find_named_export
  *
  * Find an exported function by name.
  * The loader_section must be locked while calling this function.
  */
-static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports,
+static FARPROC find_named_export( WINE_MODREF *wm, const IMAGE_EXPORT_DIRECTORY *exports,
                                   DWORD exp_size, const char *name, int hint, LPCWSTR load_path )
 {
+    HMODULE module = wm->ldr.DllBase;
     const WORD *ordinals = get_rva( module, exports->AddressOfNameOrdinals );
     const DWORD *names = get_rva( module, exports->AddressOfNames );
     int ordinal;
@@ -1061,8 +1161,10 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
             return find_ordinal_export( module, exports, exp_size, ordinals[hint], load_path );
     }
 
-    /* then do a binary search */
-    if ((ordinal = find_name_in_exports( module, exports, name )) == -1) return NULL;
+    /* then use the hash table, or do a binary search for small export tables */
+    if ((ordinal = find_hashed_export( wm, exports, name )) == -2)
+        ordinal = find_name_in_exports( module, exports, name );
+    if (ordinal == -1) return NULL;
     return find_ordinal_export( module, exports, exp_size, ordinal, load_path );
 
 }
@@ -1203,7 +1305,7 @@ static BOOL import_dll( HMODULE module, const IMAGE_IMPORT_DESCRIPTOR *descr, LP
         {
             IMAGE_IMPORT_BY_NAME *pe_name;
             pe_name = get_rva( module, (DWORD)import_list->u1.AddressOfData );
-            thunk_list->u1.Function = (ULONG_PTR)find_named_export( imp_mod, exports, exp_size,
+            thunk_list->u1.Function = (ULONG_PTR)find_named_export( wmImp, exports, exp_size,
                                                                     (const char*)pe_name->Name,
                                                                     pe_name->Hint, load_path );
             if (!thunk_list->u1.Function)
@@ -1540,6 +1642,11 @@ static WINE_MODREF *alloc_module( HMODULE hModule, const UNICODE_STRING *nt_name
                    &wm->ldr.InMemoryOrderLinks);
     /* wait until init is called for inserting into InInitializationOrderModuleList */
 
+    wm->ldr.BaseNameHashValue = hash_basename( &wm->ldr.BaseDllName );
+    InsertTailList(&hash_table[wm->ldr.BaseNameHashValue % HASH_MAP_SIZE], &wm->ldr.HashLinks);
+    /* the file id is set by the caller, if known */
+    InitializeListHead(&wm->id_links);
+
     if (!(nt->OptionalHeader.DllCharacteristics & IMAGE_DLLCHARACTERISTICS_NX_COMPAT))
     {
         ULONG flags = MEM_EXECUTE_OPTION_ENABLE;
@@ -2028,7 +2135,7 @@ NTSTATUS WINAPI LdrGetProcedureAddress(HMODULE module, const ANSI_STRING *name,
     else if ((exports = RtlImageDirectoryEntryToData( module, TRUE,
                                                       IMAGE_DIRECTORY_ENTRY_EXPORT, &exp_size )))
     {
-        void *proc = name ? find_named_export( module, exports, exp_size, name->Buffer, -1, NULL )
+        void *proc = name ? find_named_export( wm, exports, exp_size, name->Buffer, -1, NULL )
                           : find_ordinal_export( module, exports, exp_size, ord - exports->Base, NULL );
         if (proc)
         {
@@ -2214,7 +2321,11 @@ static NTSTATUS build_module( LPCWSTR load_path, const UNICODE_STRING *nt_name,
 
     if (!(wm = alloc_module( *module, nt_name, is_builtin ))) return STATUS_NO_MEMORY;
 
-    if (id) wm->id = *id;
+    if (id)
+    {
+        wm->id = *id;
+        InsertTailList(&fileid_hash_table[hash_file_id( id )], &wm->id_links);
+    }
     if (image_info->LoaderFlags) wm->ldr.Flags |= LDR_COR_IMAGE;
     if (image_info->ComPlusILOnly) wm->ldr.Flags |= LDR_COR_ILONLY;
     wm->system = system;
@@ -2233,9 +2344,11 @@ static NTSTATUS build_module( LPCWSTR load_path, const UNICODE_STRING *nt_name,
             status = fixup_imports( wm, load_path );
         if (status != STATUS_SUCCESS)
         {
-            /* the module has only be inserted in the load & memory order lists */
+            /* the module has only be inserted in the load & memory order lists and hash tables */
             RemoveEntryList(&wm->ldr.InLoadOrderLinks);
             RemoveEntryList(&wm->ldr.InMemoryOrderLinks);
+            RemoveEntryList(&wm->ldr.HashLinks);
+            RemoveEntryList(&wm->id_links);
 
             /* FIXME: there are several more dangling references
              * left. Including dlls loaded by this dll before the
@@ -4294,6 +4407,8 @@ static void free_modref( WINE_MODREF *wm )
 
     RemoveEntryList(&wm->ldr.InLoadOrderLinks);
     RemoveEntryList(&wm->ldr.InMemoryOrderLinks);
+    RemoveEntryList(&wm->ldr.HashLinks);
+    RemoveEntryList(&wm->id_links);
     if (wm->ldr.InInitializationOrderLinks.Flink)
         RemoveEntryList(&wm->ldr.InInitializationOrderLinks);
 
@@ -4326,6 +4441,7 @@ static void free_modref( WINE_MODREF *wm )
     NtUnmapViewOfSection( NtCurrentProcess(), wm->ldr.DllBase );
     if (cached_modref == wm) cached_modref = NULL;
     RtlFreeUnicodeString( &wm->ldr.FullDllName );
+    RtlFreeHeap( GetProcessHeap(), 0, wm->export_hash );
     RtlFreeHeap( GetProcessHeap(), 0, wm );
 }
 
@@ -4701,6 +4817,7 @@ void loader_init( CONTEXT *context, void **entry )
         ANSI_STRING ctrl_routine = RTL_CONSTANT_STRING( "CtrlRoutine" );
         WINE_MODREF *kernel32;
         PEB *peb = NtCurrentTeb()->Peb;
+        unsigned int i;
 
         peb->LdrData            = &ldr;
         peb->FastPebLock        = &peb_lock;
@@ -4709,6 +4826,12 @@ void loader_init( CONTEXT *context, void **entry )
         peb->LoaderLock         = &loader_section;
         peb->ProcessHeap        = RtlCreateHeap( HEAP_GROWABLE, NULL, 0, 0, NULL, NULL );
 
+        for (i = 0; i < HASH_MAP_SIZE; i++)
+        {
+            InitializeListHead( &hash_table[i] );
+            InitializeListHead( &fileid_hash_table[i] );
+        }
+
         RtlInitializeBitMap( &tls_bitmap, peb->TlsBitmapBits, sizeof(peb->TlsBitmapBits) * 8 );
         RtlInitializeBitMap( &tls_expansion_bitmap, peb->TlsExpansionBitmapBits,
                              sizeof(peb->TlsExpansionBitmapBits) * 8 );
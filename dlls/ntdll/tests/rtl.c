@@ -3668,6 +3668,38 @@ static void test_RtlFindExportedRoutineByName(void)
     ok( proc == NULL, "Shouldn't find forwarded function\n" );
 }
 
+static void test_GetProcAddress_all_exports(void)
+{
+    HMODULE module = GetModuleHandleW( L"ntdll" );
+    const IMAGE_EXPORT_DIRECTORY *exports;
+    const DWORD *names, *functions;
+    const WORD *ordinals;
+    char name[64];
+    ULONG size, i;
+    void *proc;
+
+    exports = RtlImageDirectoryEntryToData( module, TRUE, IMAGE_DIRECTORY_ENTRY_EXPORT, &size );
+    ok( exports != NULL, "no export directory\n" );
+    if (!exports) return;
+    names = (const DWORD *)((const char *)module + exports->AddressOfNames);
+    ordinals = (const WORD *)((const char *)module + exports->AddressOfNameOrdinals);
+    functions = (const DWORD *)((const char *)module + exports->AddressOfFunctions);
+
+    for (i = 0; i < exports->NumberOfNames; i++)
+    {
+        const char *export_name = (const char *)module + names[i];
+
+        proc = GetProcAddress( module, export_name );
+        ok( proc == (const char *)module + functions[ordinals[i]], "wrong address %p for %s\n",
+            proc, export_name );
+        if (strlen( export_name ) + 2 > sizeof(name)) continue;
+        strcpy( name, export_name );
+        strcat( name, "_" );
+        proc = GetProcAddress( module, name );
+        ok( !proc, "found %s at %p\n", name, proc );
+    }
+}
+
 START_TEST(rtl)
 {
     InitFunctionPtrs();
@@ -3715,4 +3747,5 @@ START_TEST(rtl)
     test_RtlInitializeSid();
     test_RtlValidSecurityDescriptor();
     test_RtlFindExportedRoutineByName();
+    test_GetProcAddress_all_exports();
 }
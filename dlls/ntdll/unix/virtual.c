@@ -27,6 +27,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
@@ -2735,6 +2736,28 @@ static IMAGE_BASE_RELOCATION *process_relocation_block( char *page, IMAGE_BASE_R
 }
 
 
+/***********************************************************************
+ *           prefetch_image_section
+ *
+ * Start reading a mapped image section in the background, so that the
+ * page faults from relocations, import fixups and the dll entry point
+ * don't have to wait for the disk one page at a time. The reads of all
+ * the dlls mapped by the loader thus proceed in parallel.
+ */
+static void prefetch_image_section( int fd, SIZE_T start, SIZE_T size )
+{
+#ifdef HAVE_POSIX_FADVISE
+    posix_fadvise( fd, start, size, POSIX_FADV_WILLNEED );
+#elif defined(F_RDADVISE)
+    struct radvisory ra;
+
+    ra.ra_offset = start;
+    ra.ra_count = min( size, INT_MAX );
+    fcntl( fd, F_RDADVISE, &ra );
+#endif
+}
+
+
 /***********************************************************************
  *           map_image_into_view
  *
@@ -2743,13 +2766,13 @@ static IMAGE_BASE_RELOCATION *process_relocation_block( char *page, IMAGE_BASE_R
  */
 static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filename, int fd,
                                      pe_image_info_t *image_info, USHORT machine,
-                                     int shared_fd, BOOL removable )
+                                     int shared_fd, int reloc_fd, BOOL removable )
 {
     IMAGE_DOS_HEADER *dos;
     IMAGE_NT_HEADERS *nt;
     IMAGE_SECTION_HEADER sections[96];
     IMAGE_SECTION_HEADER *sec;
-    IMAGE_DATA_DIRECTORY *imports, *dir;
+    IMAGE_DATA_DIRECTORY *imports, *resources, *dir;
     NTSTATUS status = STATUS_CONFLICTING_ADDRESSES;
     int i;
     off_t pos;
@@ -2781,6 +2804,7 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
     memcpy(sections, sec, sizeof(*sections) * nt->FileHeader.NumberOfSections);
     sec = sections;
     imports = get_data_dir( nt, total_size, IMAGE_DIRECTORY_ENTRY_IMPORT );
+    resources = get_data_dir( nt, total_size, IMAGE_DIRECTORY_ENTRY_RESOURCE );
 
     /* check for non page-aligned binary */
 
@@ -2815,6 +2839,8 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
     {
         static const SIZE_T sector_align = 0x1ff;
         SIZE_T map_size, file_start, file_size, end;
+        int map_fd = fd;
+        off_t map_pos;
 
         if (!sec->Misc.VirtualSize)
             map_size = ROUND_SIZE( 0, sec->SizeOfRawData );
@@ -2872,6 +2898,15 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
 
         if (!sec->PointerToRawData || !file_size) continue;
 
+        /* the server provides the sections already relocated to the dynamic base,
+         * stored at their virtual address */
+        map_pos = file_start;
+        if (reloc_fd != -1)
+        {
+            map_fd = reloc_fd;
+            map_pos = sec->VirtualAddress;
+        }
+
         /* Note: if the section is not aligned properly map_file_into_view will magically
          *       fall back to read(), so we don't need to check anything here.
          */
@@ -2879,16 +2914,21 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
         if (sec->PointerToRawData >= st.st_size ||
             end > ((st.st_size + sector_align) & ~sector_align) ||
             end < file_start ||
-            map_file_into_view( view, fd, sec->VirtualAddress, file_size, file_start,
+            map_file_into_view( view, map_fd, sec->VirtualAddress, file_size, map_pos,
                                 VPROT_COMMITTED | VPROT_READ | VPROT_WRITECOPY,
-                                removable ) != STATUS_SUCCESS)
+                                removable && map_fd == fd ) != STATUS_SUCCESS)
         {
             ERR_(module)( "Could not map %s section %.8s, file probably truncated\n",
                           debugstr_w(filename), sec->Name );
             return status;
         }
 
-        if (file_size & page_mask)
+        /* resources are usually large and only loaded on demand */
+        if (!removable && !(resources && resources->VirtualAddress >= sec->VirtualAddress &&
+                            resources->VirtualAddress < sec->VirtualAddress + map_size))
+            prefetch_image_section( map_fd, map_pos, file_size );
+
+        if ((file_size & page_mask) && map_fd == fd)
         {
             end = ROUND_SIZE( 0, file_size );
             if (end > map_size) end = map_size;
@@ -2928,7 +2968,7 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
         else
             ((IMAGE_NT_HEADERS32 *)nt)->OptionalHeader.ImageBase = image_info->map_addr;
 
-        if ((dir = get_data_dir( nt, total_size, IMAGE_DIRECTORY_ENTRY_BASERELOC )))
+        if (reloc_fd == -1 && (dir = get_data_dir( nt, total_size, IMAGE_DIRECTORY_ENTRY_BASERELOC )))
         {
             IMAGE_BASE_RELOCATION *rel = (IMAGE_BASE_RELOCATION *)(ptr + dir->VirtualAddress);
             IMAGE_BASE_RELOCATION *end = (IMAGE_BASE_RELOCATION *)((char *)rel + dir->Size);
@@ -2973,7 +3013,8 @@ static NTSTATUS map_image_into_view( struct file_view *view, const WCHAR *filena
  *             get_mapping_info
  */
 static unsigned int get_mapping_info( HANDLE handle, ACCESS_MASK access, unsigned int *sec_flags,
-                                      mem_size_t *full_size, HANDLE *shared_file, pe_image_info_t **info )
+                                      mem_size_t *full_size, HANDLE *shared_file, HANDLE *reloc_file,
+                                      pe_image_info_t **info )
 {
     pe_image_info_t *image_info;
     SIZE_T total, size = 1024;
@@ -2993,12 +3034,14 @@ static unsigned int get_mapping_info( HANDLE handle, ACCESS_MASK access, unsigne
             *full_size   = reply->size;
             total        = reply->total;
             *shared_file = wine_server_ptr_handle( reply->shared_file );
+            *reloc_file  = wine_server_ptr_handle( reply->reloc_file );
         }
         SERVER_END_REQ;
         if (!status && total <= size - sizeof(WCHAR)) break;
         free( image_info );
         if (status) return status;
         if (*shared_file) NtClose( *shared_file );
+        if (*reloc_file) NtClose( *reloc_file );
         size = total + sizeof(WCHAR);
     }
 
@@ -3083,12 +3126,13 @@ static NTSTATUS map_image_view( struct file_view **view_ret, pe_image_info_t *im
  * Map a PE image section into memory.
  */
 static NTSTATUS virtual_map_image( HANDLE mapping, void **addr_ptr, SIZE_T *size_ptr, HANDLE shared_file,
-                                   ULONG_PTR limit_low, ULONG_PTR limit_high, ULONG alloc_type,
-                                   USHORT machine, pe_image_info_t *image_info,
+                                   HANDLE reloc_file, ULONG_PTR limit_low, ULONG_PTR limit_high,
+                                   ULONG alloc_type, USHORT machine, pe_image_info_t *image_info,
                                    WCHAR *filename, BOOL is_builtin )
 {
     int unix_fd = -1, needs_close;
     int shared_fd = -1, shared_needs_close = 0;
+    int reloc_fd = -1, reloc_needs_close = 0;
     SIZE_T size = image_info->map_size;
     struct file_view *view;
     unsigned int status;
@@ -3104,6 +3148,11 @@ static NTSTATUS virtual_map_image( HANDLE mapping, void **addr_ptr, SIZE_T *size
         return status;
     }
 
+    /* the relocated sections are only an optimization, ignore errors */
+    if (reloc_file && server_get_unix_fd( reloc_file, FILE_READ_DATA, &reloc_fd, &reloc_needs_close,
+                                          NULL, NULL ))
+        reloc_fd = -1;
+
     if (peb->OSMajorVersion > 5 && /* CW HACK 22939: ASLR is supported only on Windows Vista and later */
         !image_info->map_addr &&
         (image_info->image_charact & IMAGE_FILE_DLL) &&
@@ -3122,7 +3171,8 @@ static NTSTATUS virtual_map_image( HANDLE mapping, void **addr_ptr, SIZE_T *size
     status = map_image_view( &view, image_info, size, limit_low, limit_high, alloc_type );
     if (status) goto done;
 
-    status = map_image_into_view( view, filename, unix_fd, image_info, machine, shared_fd, needs_close );
+    status = map_image_into_view( view, filename, unix_fd, image_info, machine, shared_fd, reloc_fd,
+                                  needs_close );
     if (status == STATUS_SUCCESS)
     {
         SERVER_START_REQ( map_image_view )
@@ -3149,6 +3199,7 @@ done:
     server_leave_uninterrupted_section( &virtual_mutex, &sigset );
     if (needs_close) close( unix_fd );
     if (shared_needs_close) close( shared_fd );
+    if (reloc_needs_close) close( reloc_fd );
     return status;
 }
 
@@ -3173,7 +3224,7 @@ static unsigned int virtual_map_section( HANDLE handle, PVOID *addr_ptr, ULONG_P
     int unix_handle = -1, needs_close;
     unsigned int vprot, sec_flags;
     struct file_view *view;
-    HANDLE shared_file;
+    HANDLE shared_file, reloc_file;
     LARGE_INTEGER offset;
     sigset_t sigset;
 
@@ -3199,7 +3250,7 @@ static unsigned int virtual_map_section( HANDLE handle, PVOID *addr_ptr, ULONG_P
         return STATUS_INVALID_PAGE_PROTECTION;
     }
 
-    res = get_mapping_info( handle, access, &sec_flags, &full_size, &shared_file, &image_info );
+    res = get_mapping_info( handle, access, &sec_flags, &full_size, &shared_file, &reloc_file, &image_info );
     if (res) return res;
 
     if (image_info)
@@ -3208,9 +3259,10 @@ static unsigned int virtual_map_section( HANDLE handle, PVOID *addr_ptr, ULONG_P
         /* check if we can replace that mapping with the builtin */
         res = load_builtin( image_info, filename, machine, addr_ptr, size_ptr, limit_low, limit_high );
         if (res == STATUS_IMAGE_ALREADY_LOADED)
-            res = virtual_map_image( handle, addr_ptr, size_ptr, shared_file, limit_low, limit_high,
+            res = virtual_map_image( handle, addr_ptr, size_ptr, shared_file, reloc_file, limit_low, limit_high,
                                      alloc_type, machine, image_info, filename, FALSE );
         if (shared_file) NtClose( shared_file );
+        if (reloc_file) NtClose( reloc_file );
         free( image_info );
         return res;
     }
@@ -3443,13 +3495,13 @@ NTSTATUS virtual_map_builtin_module( HANDLE mapping, void **module, SIZE_T *size
 {
     mem_size_t full_size;
     unsigned int sec_flags;
-    HANDLE shared_file;
+    HANDLE shared_file, reloc_file;
     pe_image_info_t *image_info = NULL;
     NTSTATUS status;
     WCHAR *filename;
 
     if ((status = get_mapping_info( mapping, SECTION_MAP_READ,
-                                    &sec_flags, &full_size, &shared_file, &image_info )))
+                                    &sec_flags, &full_size, &shared_file, &reloc_file, &image_info )))
         return status;
 
     if (!image_info) return STATUS_INVALID_PARAMETER;
@@ -3470,12 +3522,13 @@ NTSTATUS virtual_map_builtin_module( HANDLE mapping, void **module, SIZE_T *size
     }
     else
     {
-        status = virtual_map_image( mapping, module, size, shared_file, limit_low, limit_high, 0,
+        status = virtual_map_image( mapping, module, size, shared_file, reloc_file, limit_low, limit_high, 0,
                                     machine, image_info, filename, TRUE );
         virtual_fill_image_information( image_info, info );
     }
 
     if (shared_file) NtClose( shared_file );
+    if (reloc_file) NtClose( reloc_file );
     free( image_info );
     return status;
 }
@@ -3490,12 +3543,12 @@ NTSTATUS virtual_map_module( HANDLE mapping, void **module, SIZE_T *size, SECTIO
     unsigned int status;
     mem_size_t full_size;
     unsigned int sec_flags;
-    HANDLE shared_file;
+    HANDLE shared_file, reloc_file;
     pe_image_info_t *image_info = NULL;
     WCHAR *filename;
 
     if ((status = get_mapping_info( mapping, SECTION_MAP_READ,
-                                    &sec_flags, &full_size, &shared_file, &image_info )))
+                                    &sec_flags, &full_size, &shared_file, &reloc_file, &image_info )))
         return status;
 
     if (!image_info) return STATUS_INVALID_PARAMETER;
@@ -3507,11 +3560,12 @@ NTSTATUS virtual_map_module( HANDLE mapping, void **module, SIZE_T *size, SECTIO
     /* check if we can replace that mapping with the builtin */
     status = load_builtin( image_info, filename, machine, module, size, limit_low, limit_high );
     if (status == STATUS_IMAGE_ALREADY_LOADED)
-        status = virtual_map_image( mapping, module, size, shared_file, limit_low, limit_high, 0,
+        status = virtual_map_image( mapping, module, size, shared_file, reloc_file, limit_low, limit_high, 0,
                                     machine, image_info, filename, FALSE );
 
     virtual_fill_image_information( image_info, info );
     if (shared_file) NtClose( shared_file );
+    if (reloc_file) NtClose( reloc_file );
     free( image_info );
     return status;
 }
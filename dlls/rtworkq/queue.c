@@ -130,6 +130,7 @@ struct work_item
     IUnknown IUnknown_iface;
     LONG refcount;
     struct list entry;
+    SLIST_ENTRY slist_entry;
     IRtwqAsyncResult *result;
     IRtwqAsyncResult *reply_result;
     struct queue *queue;
@@ -151,6 +152,10 @@ static struct work_item *work_item_impl_from_IUnknown(IUnknown *iface)
     return CONTAINING_RECORD(iface, struct work_item, IUnknown_iface);
 }
 
+/* Released items are kept for reuse, most of them are short lived and created at a high rate. */
+#define MAX_FREE_WORK_ITEMS 256
+static SLIST_HEADER free_work_items;
+
 static const TP_CALLBACK_PRIORITY priorities[] =
 {
     TP_CALLBACK_PRIORITY_HIGH,
@@ -175,6 +180,12 @@ struct queue_desc
     DWORD target_queue;
 };
 
+struct pool_queue_batch
+{
+    SLIST_HEADER items;
+    TP_WORK *work_object;
+};
+
 struct queue
 {
     IRtwqAsyncCallback IRtwqAsyncCallback_iface;
@@ -184,6 +195,8 @@ struct queue
     CRITICAL_SECTION cs;
     struct list pending_items;
     DWORD id;
+    /* Data used for single threaded pool queues only. */
+    struct pool_queue_batch batches[ARRAY_SIZE(priorities)];
     /* Data used for serial queues only. */
     PTP_SIMPLE_CALLBACK finalization_callback;
     DWORD target_queue;
@@ -316,6 +329,49 @@ static void CALLBACK standard_queue_cleanup_callback(void *object_data, void *gr
 {
 }
 
+static void invoke_work_item(struct work_item *item)
+{
+    RTWQASYNCRESULT *result = (RTWQASYNCRESULT *)item->result;
+
+    TRACE("result object %p.\n", result);
+
+    /* Submitting from serial queue in reply mode, use different result object acting as receipt token.
+       It's submitted to user callback still, but when invoked, special serial queue callback will be used
+       to ensure correct destination queue. */
+
+    IRtwqAsyncCallback_Invoke(result->pCallback, item->reply_result ? item->reply_result : item->result);
+}
+
+static void CALLBACK pool_queue_batch_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+{
+    struct pool_queue_batch *batch = context;
+    SLIST_ENTRY *entry, *next, *head = NULL;
+    struct work_item *item;
+
+    /* Every item that was pushed since the last run is handled at once, list is reversed
+       to invoke them in submission order. */
+    entry = InterlockedFlushSList(&batch->items);
+    while (entry)
+    {
+        next = entry->Next;
+        entry->Next = head;
+        head = entry;
+        entry = next;
+    }
+
+    while ((entry = head))
+    {
+        head = entry->Next;
+        item = CONTAINING_RECORD(entry, struct work_item, slist_entry);
+
+        invoke_work_item(item);
+        if (item->finalization_callback)
+            item->finalization_callback(instance, item);
+
+        IUnknown_Release(&item->IUnknown_iface);
+    }
+}
+
 static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queue)
 {
     TP_CALLBACK_ENVIRON_V3 env;
@@ -343,6 +399,18 @@ static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queu
     SetThreadpoolThreadMinimum(queue->pool, 1);
     SetThreadpoolThreadMaximum(queue->pool, max_thread);
 
+    /* Callbacks are serialized anyway on single threaded queues, items are queued without locking
+       and dispatched in batches, using a single work object per priority. */
+    if (max_thread == 1)
+    {
+        for (i = 0; i < ARRAY_SIZE(queue->batches); ++i)
+        {
+            InitializeSListHead(&queue->batches[i].items);
+            queue->batches[i].work_object = CreateThreadpoolWork(pool_queue_batch_worker, &queue->batches[i],
+                    (TP_CALLBACK_ENVIRON *)&queue->envs[i]);
+        }
+    }
+
     if (desc->queue_type == RTWQ_WINDOW_WORKQUEUE)
         FIXME("RTWQ_WINDOW_WORKQUEUE is not supported.\n");
 
@@ -351,6 +419,9 @@ static HRESULT pool_queue_init(const struct queue_desc *desc, struct queue *queu
 
 static BOOL pool_queue_shutdown(struct queue *queue)
 {
+    SLIST_ENTRY *entry, *next;
+    unsigned int i;
+
     if (!queue->pool)
         return FALSE;
 
@@ -358,21 +429,30 @@ static BOOL pool_queue_shutdown(struct queue *queue)
     CloseThreadpool(queue->pool);
     queue->pool = NULL;
 
+    /* Release items that were never dispatched. */
+    for (i = 0; i < ARRAY_SIZE(queue->batches); ++i)
+    {
+        if (!queue->batches[i].work_object)
+            continue;
+
+        entry = InterlockedFlushSList(&queue->batches[i].items);
+        while (entry)
+        {
+            next = entry->Next;
+            IUnknown_Release(&CONTAINING_RECORD(entry, struct work_item, slist_entry)->IUnknown_iface);
+            entry = next;
+        }
+        queue->batches[i].work_object = NULL;
+    }
+
     return TRUE;
 }
 
 static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
 {
     struct work_item *item = context;
-    RTWQASYNCRESULT *result = (RTWQASYNCRESULT *)item->result;
 
-    TRACE("result object %p.\n", result);
-
-    /* Submitting from serial queue in reply mode, use different result object acting as receipt token.
-       It's submitted to user callback still, but when invoked, special serial queue callback will be used
-       to ensure correct destination queue. */
-
-    IRtwqAsyncCallback_Invoke(result->pCallback, item->reply_result ? item->reply_result : item->result);
+    invoke_work_item(item);
 
     IUnknown_Release(&item->IUnknown_iface);
 }
@@ -380,6 +460,7 @@ static void CALLBACK standard_queue_worker(TP_CALLBACK_INSTANCE *instance, void
 static void pool_queue_submit(struct queue *queue, struct work_item *item)
 {
     TP_CALLBACK_PRIORITY callback_priority;
+    struct pool_queue_batch *batch;
     TP_CALLBACK_ENVIRON_V3 env;
 
     if (item->priority == 0)
@@ -389,6 +470,21 @@ static void pool_queue_submit(struct queue *queue, struct work_item *item)
     else
         callback_priority = TP_CALLBACK_PRIORITY_HIGH;
 
+    batch = &queue->batches[callback_priority];
+    if (batch->work_object)
+    {
+        /* Reference is released by the batch worker, after finalization callback. */
+        if (item->finalization_callback)
+            IUnknown_AddRef(&item->IUnknown_iface);
+        item->type = WORK_ITEM_WORK;
+        /* Worker is only submitted on empty to non-empty transition, it flushes the whole list. */
+        if (!InterlockedPushEntrySList(&batch->items, &item->slist_entry))
+            SubmitThreadpoolWork(batch->work_object);
+
+        TRACE("queued %p.\n", item->result);
+        return;
+    }
+
     env = queue->envs[callback_priority];
     env.FinalizationCallback = item->finalization_callback;
     /* Worker pool callback will release one reference. Grab one more to keep object alive when
@@ -573,7 +669,10 @@ static ULONG WINAPI work_item_Release(IUnknown *iface)
         if (item->reply_result)
             IRtwqAsyncResult_Release(item->reply_result);
         IRtwqAsyncResult_Release(item->result);
-        free(item);
+        if (QueryDepthSList(&free_work_items) < MAX_FREE_WORK_ITEMS)
+            InterlockedPushEntrySList(&free_work_items, &item->slist_entry);
+        else
+            free(item);
     }
 
     return refcount;
@@ -591,8 +690,15 @@ static struct work_item * alloc_work_item(struct queue *queue, LONG priority, IR
     RTWQASYNCRESULT *async_result = (RTWQASYNCRESULT *)result;
     DWORD flags = 0, queue_id = 0;
     struct work_item *item;
+    SLIST_ENTRY *entry;
 
-    item = calloc(1, sizeof(*item));
+    if ((entry = InterlockedPopEntrySList(&free_work_items)))
+    {
+        item = CONTAINING_RECORD(entry, struct work_item, slist_entry);
+        memset(item, 0, sizeof(*item));
+    }
+    else if (!(item = calloc(1, sizeof(*item))))
+        return NULL;
 
     item->IUnknown_iface.lpVtbl = &work_item_vtbl;
     item->result = result;
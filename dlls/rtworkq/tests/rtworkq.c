@@ -19,6 +19,8 @@
 #include <stdarg.h>
 #include <string.h>
 
+#define COBJMACROS
+
 #include "windef.h"
 #include "winbase.h"
 #include "rtworkq.h"
@@ -101,7 +103,108 @@ static void test_platform_init(void)
     ok(hr == S_OK, "Failed to shut down, hr %#lx.\n", hr);
 }
 
+struct order_callback
+{
+    IRtwqAsyncCallback IRtwqAsyncCallback_iface;
+    IRtwqAsyncResult *results[1000];
+    LONG count;
+    LONG mismatches;
+    HANDLE event;
+};
+
+static struct order_callback *impl_from_IRtwqAsyncCallback(IRtwqAsyncCallback *iface)
+{
+    return CONTAINING_RECORD(iface, struct order_callback, IRtwqAsyncCallback_iface);
+}
+
+static HRESULT WINAPI order_callback_QueryInterface(IRtwqAsyncCallback *iface, REFIID riid, void **obj)
+{
+    *obj = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG WINAPI order_callback_AddRef(IRtwqAsyncCallback *iface)
+{
+    return 2;
+}
+
+static ULONG WINAPI order_callback_Release(IRtwqAsyncCallback *iface)
+{
+    return 1;
+}
+
+static HRESULT WINAPI order_callback_GetParameters(IRtwqAsyncCallback *iface, DWORD *flags, DWORD *queue)
+{
+    return E_NOTIMPL;
+}
+
+static HRESULT WINAPI order_callback_Invoke(IRtwqAsyncCallback *iface, IRtwqAsyncResult *result)
+{
+    struct order_callback *callback = impl_from_IRtwqAsyncCallback(iface);
+    LONG index;
+
+    index = InterlockedIncrement(&callback->count) - 1;
+    if (index >= ARRAY_SIZE(callback->results) || result != callback->results[index])
+        InterlockedIncrement(&callback->mismatches);
+    if (index == ARRAY_SIZE(callback->results) - 1)
+        SetEvent(callback->event);
+
+    return S_OK;
+}
+
+static const IRtwqAsyncCallbackVtbl order_callback_vtbl =
+{
+    order_callback_QueryInterface,
+    order_callback_AddRef,
+    order_callback_Release,
+    order_callback_GetParameters,
+    order_callback_Invoke,
+};
+
+static void test_work_queue_order(void)
+{
+    static struct order_callback callback = {{&order_callback_vtbl}};
+    DWORD queue, res;
+    unsigned int i;
+    HRESULT hr;
+
+    hr = RtwqStartup();
+    ok(hr == S_OK, "Failed to start up, hr %#lx.\n", hr);
+
+    hr = RtwqAllocateWorkQueue(RTWQ_STANDARD_WORKQUEUE, &queue);
+    ok(hr == S_OK, "Failed to allocate a queue, hr %#lx.\n", hr);
+
+    /* Items of the same priority are invoked in submission order. */
+    callback.event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    for (i = 0; i < ARRAY_SIZE(callback.results); ++i)
+    {
+        hr = RtwqCreateAsyncResult(NULL, &callback.IRtwqAsyncCallback_iface, NULL, &callback.results[i]);
+        ok(hr == S_OK, "Failed to create result object, hr %#lx.\n", hr);
+    }
+    for (i = 0; i < ARRAY_SIZE(callback.results); ++i)
+    {
+        hr = RtwqPutWorkItem(queue, 0, callback.results[i]);
+        ok(hr == S_OK, "Failed to queue item, hr %#lx.\n", hr);
+    }
+
+    res = WaitForSingleObject(callback.event, 5000);
+    ok(res == WAIT_OBJECT_0, "Unexpected wait result %#lx.\n", res);
+    ok(callback.count == ARRAY_SIZE(callback.results), "Unexpected count %ld.\n", callback.count);
+    ok(!callback.mismatches, "Got %ld items out of order.\n", callback.mismatches);
+
+    for (i = 0; i < ARRAY_SIZE(callback.results); ++i)
+        IRtwqAsyncResult_Release(callback.results[i]);
+    CloseHandle(callback.event);
+
+    hr = RtwqUnlockWorkQueue(queue);
+    ok(hr == S_OK, "Failed to unlock the queue, hr %#lx.\n", hr);
+
+    hr = RtwqShutdown();
+    ok(hr == S_OK, "Failed to shut down, hr %#lx.\n", hr);
+}
+
 START_TEST(rtworkq)
 {
     test_platform_init();
+    test_work_queue_order();
 }
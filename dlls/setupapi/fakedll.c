@@ -31,6 +31,7 @@
 #include "windef.h"
 #include "winbase.h"
 #include "winuser.h"
+#include "winreg.h"
 #include "winnt.h"
 #include "winternl.h"
 #include "wine/debug.h"
@@ -70,6 +71,7 @@ static unsigned int handled_count;
 static unsigned int handled_total;
 static WCHAR **handled_dlls;
 static IRegistrar *registrar;
+static HKEY registered_key;
 
 struct dll_info
 {
@@ -481,6 +483,14 @@ done:
     return NULL;
 }
 
+/* check if the file is linked to some other file, such as the builtin it was created from */
+static BOOL is_linked_file( HANDLE h )
+{
+    BY_HANDLE_FILE_INFORMATION info;
+
+    return GetFileInformationByHandle( h, &info ) && info.nNumberOfLinks > 1;
+}
+
 /* create the fake dll destination file */
 static HANDLE create_dest_file( const WCHAR *name, BOOL delete )
 {
@@ -500,6 +510,16 @@ static HANDLE create_dest_file( const WCHAR *name, BOOL delete )
             DeleteFileW( name );
             return INVALID_HANDLE_VALUE;
         }
+        if (is_linked_file( h ))
+        {
+            /* don't truncate the file we have been linked to, create a new one instead */
+            CloseHandle( h );
+            DeleteFileW( name );
+            h = CreateFileW( name, GENERIC_WRITE, 0, NULL, CREATE_NEW, 0, NULL );
+            if (h == INVALID_HANDLE_VALUE)
+                ERR( "failed to create %s (error=%lu)\n", debugstr_w(name), GetLastError() );
+            return h;
+        }
         /* truncate the file */
         SetFilePointer( h, 0, NULL, FILE_BEGIN );
         SetEndOfFile( h );
@@ -515,6 +535,38 @@ static HANDLE create_dest_file( const WCHAR *name, BOOL delete )
     return h;
 }
 
+/* check if fake dlls should be hard links to the builtin files instead of copies */
+static BOOL use_hard_links(void)
+{
+    const WCHAR *env = _wgetenv( L"WINEDLLHARDLINKS" );
+
+    /* not the default, a program writing to the dll would modify the builtin */
+    return env && env[0] && wcscmp( env, L"0" );
+}
+
+/* replace the fake dll destination file by a hard link to the source file */
+static BOOL link_dest_file( const WCHAR *name, const WCHAR *source )
+{
+    HANDLE h;
+    BOOL ret;
+
+    if (!use_hard_links()) return FALSE;
+
+    h = CreateFileW( name, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL );
+    if (h != INVALID_HANDLE_VALUE)
+    {
+        ret = is_fake_dll( h );
+        CloseHandle( h );
+        if (!ret || !DeleteFileW( name )) return FALSE;
+    }
+    else if (GetLastError() == ERROR_PATH_NOT_FOUND) create_directories( name );
+
+    /* this fails if the source is on another file system, the file gets copied then */
+    if (!(ret = CreateHardLinkW( name, source, NULL )))
+        TRACE( "failed to link %s to %s (error=%lu)\n", debugstr_w(name), debugstr_w(source), GetLastError() );
+    return ret;
+}
+
 /* XML parsing code copied from ntdll */
 
 typedef struct
@@ -822,24 +874,265 @@ static BOOL CALLBACK register_manifest( HMODULE module, const WCHAR *type, WCHAR
     return TRUE;
 }
 
-static BOOL CALLBACK register_resource( HMODULE module, LPCWSTR type, LPWSTR name, LONG_PTR arg )
+/* load a registry script resource as a null-terminated string */
+static WCHAR *load_registry_script( HMODULE module, LPCWSTR type, LPWSTR name )
 {
-    HRESULT *hr = (HRESULT *)arg;
     WCHAR *buffer;
     HRSRC rsrc = FindResourceW( module, name, type );
     char *str = LoadResource( module, rsrc );
     DWORD lenW, lenA = SizeofResource( module, rsrc );
 
-    if (!str) return FALSE;
+    if (!str) return NULL;
     lenW = MultiByteToWideChar( CP_UTF8, 0, str, lenA, NULL, 0 ) + 1;
-    if (!(buffer = malloc( lenW * sizeof(WCHAR) ))) return FALSE;
+    if (!(buffer = malloc( lenW * sizeof(WCHAR) ))) return NULL;
     MultiByteToWideChar( CP_UTF8, 0, str, lenA, buffer, lenW );
     buffer[lenW - 1] = 0;
+    return buffer;
+}
+
+static BOOL CALLBACK register_resource( HMODULE module, LPCWSTR type, LPWSTR name, LONG_PTR arg )
+{
+    HRESULT *hr = (HRESULT *)arg;
+    WCHAR *buffer;
+
+    if (!(buffer = load_registry_script( module, type, name ))) return FALSE;
     *hr = IRegistrar_StringRegister( registrar, buffer );
     free( buffer );
     return TRUE;
 }
 
+/* apply the replacements to a registry script, the same way IRegistrar does */
+static WCHAR *expand_registry_script( const WCHAR *str, const WCHAR *module, const WCHAR *system_root )
+{
+    size_t module_len = wcslen( module ), root_len = wcslen( system_root );
+    size_t len = wcslen( str ) + 1;
+    const WCHAR *p, *end;
+    WCHAR *ret, *dst;
+
+    for (p = str; (p = wcschr( p, '%' )); p++) len += max( module_len, root_len );
+    if (!(ret = dst = malloc( len * sizeof(WCHAR) ))) return NULL;
+
+    for (p = str; (end = wcschr( p, '%' )); p = end + 1)
+    {
+        memcpy( dst, p, (end - p) * sizeof(WCHAR) );
+        dst += end - p;
+        p = end + 1;
+        if (!(end = wcschr( p, '%' ))) goto failed;
+        if (end == p) *dst++ = '%';
+        else if (end - p == 6 && !wcsnicmp( p, L"MODULE", 6 ))
+        {
+            memcpy( dst, module, module_len * sizeof(WCHAR) );
+            dst += module_len;
+        }
+        else if (end - p == 10 && !wcsnicmp( p, L"SystemRoot", 10 ))
+        {
+            memcpy( dst, system_root, root_len * sizeof(WCHAR) );
+            dst += root_len;
+        }
+        else goto failed;
+    }
+    wcscpy( dst, p );
+    return ret;
+
+failed:
+    free( ret );
+    return NULL;
+}
+
+/* get the next word of a registry script, using the same rules as IRegistrar */
+static const WCHAR *get_script_word( const WCHAR *str, WCHAR *buf, unsigned int size )
+{
+    unsigned int len = 0;
+
+    while (iswspace( *str )) str++;
+    if (*str == '}' || *str == '=') buf[len++] = *str++;
+    else if (*str == '\'')
+    {
+        for (str++; *str != '\'' || str[1] == '\''; str++)
+        {
+            if (!*str || len == size - 1) return NULL;
+            if (*str == '\'') str++;
+            buf[len++] = *str;
+        }
+        str++;
+    }
+    else
+    {
+        while (*str && !iswspace( *str ))
+        {
+            if (len == size - 1) return NULL;
+            buf[len++] = *str++;
+        }
+    }
+    buf[len] = 0;
+    while (iswspace( *str )) str++;
+    return str;
+}
+
+/* check that a value set by a registry script has the expected data */
+static const WCHAR *check_script_value( const WCHAR *str, HKEY key, const WCHAR *name,
+                                        WCHAR *buf, unsigned int size )
+{
+    WCHAR data[1024];
+    DWORD type, len = sizeof(data), value;
+    WCHAR kind;
+
+    if (!(str = get_script_word( str, buf, size )) || wcslen( buf ) != 1) return NULL;
+    kind = buf[0];
+    if (!(str = get_script_word( str, buf, size ))) return NULL;
+    if (RegQueryValueExW( key, name, NULL, &type, (BYTE *)data, &len )) return NULL;
+
+    switch (kind)
+    {
+    case 's':
+        if (type != REG_SZ || len != (wcslen( buf ) + 1) * sizeof(WCHAR) || wcscmp( data, buf )) return NULL;
+        break;
+    case 'd':
+        value = wcstoul( buf, NULL, 10 );
+        if (type != REG_DWORD || len != sizeof(value) || memcmp( data, &value, sizeof(value) )) return NULL;
+        break;
+    }
+    return str;
+}
+
+/* check that the keys and values of a registry script block are present */
+static const WCHAR *check_script_key( const WCHAR *str, HKEY parent, WCHAR *buf, unsigned int size )
+{
+    WCHAR name[256];
+    BOOL is_val, is_delete;
+    HKEY key;
+
+    if (!(str = get_script_word( str, buf, size ))) return NULL;
+    while (wcscmp( buf, L"}" ))
+    {
+        if (!buf[0]) return NULL;
+        is_val = !wcsicmp( buf, L"val" );
+        is_delete = !wcsicmp( buf, L"Delete" );
+        if ((is_val || is_delete || !wcsicmp( buf, L"NoRemove" ) || !wcsicmp( buf, L"ForceRemove" )) &&
+            !(str = get_script_word( str, buf, size ))) return NULL;
+        if (wcslen( buf ) >= ARRAY_SIZE(name)) return NULL;
+        wcscpy( name, buf );
+
+        if (is_delete)
+        {
+            /* nothing to check, the key is deleted */
+        }
+        else if (is_val)
+        {
+            if (*str != '=') return NULL;
+            if (!(str = check_script_value( str + 1, parent, name, buf, size ))) return NULL;
+        }
+        else
+        {
+            if (RegOpenKeyExW( parent, name, 0, KEY_READ, &key )) return NULL;
+            if (*str == '=') str = check_script_value( str + 1, key, NULL, buf, size );
+            if (str && *str == '{' && iswspace( str[1] )) str = check_script_key( str + 1, key, buf, size );
+            RegCloseKey( key );
+            if (!str) return NULL;
+        }
+        if (!(str = get_script_word( str, buf, size ))) return NULL;
+    }
+    return str;
+}
+
+/* check that the keys and values created by a registry script are still present */
+static BOOL check_registry_script( const WCHAR *str )
+{
+    static const struct
+    {
+        const WCHAR *name;
+        HKEY key;
+    } root_keys[] =
+    {
+        { L"HKEY_CLASSES_ROOT",     HKEY_CLASSES_ROOT },
+        { L"HKEY_CURRENT_USER",     HKEY_CURRENT_USER },
+        { L"HKEY_LOCAL_MACHINE",    HKEY_LOCAL_MACHINE },
+        { L"HKEY_USERS",            HKEY_USERS },
+        { L"HKEY_PERFORMANCE_DATA", HKEY_PERFORMANCE_DATA },
+        { L"HKEY_DYN_DATA",         HKEY_DYN_DATA },
+        { L"HKEY_CURRENT_CONFIG",   HKEY_CURRENT_CONFIG },
+        { L"HKCR",                  HKEY_CLASSES_ROOT },
+        { L"HKCU",                  HKEY_CURRENT_USER },
+        { L"HKLM",                  HKEY_LOCAL_MACHINE },
+        { L"HKU",                   HKEY_USERS },
+        { L"HKPD",                  HKEY_PERFORMANCE_DATA },
+        { L"HKDD",                  HKEY_DYN_DATA },
+        { L"HKCC",                  HKEY_CURRENT_CONFIG },
+    };
+    WCHAR buf[1024];
+    unsigned int i;
+
+    if (!(str = get_script_word( str, buf, ARRAY_SIZE(buf) ))) return FALSE;
+    while (buf[0])
+    {
+        for (i = 0; i < ARRAY_SIZE(root_keys); i++) if (!wcsicmp( buf, root_keys[i].name )) break;
+        if (i == ARRAY_SIZE(root_keys)) return FALSE;
+        if (!(str = get_script_word( str, buf, ARRAY_SIZE(buf) )) || wcscmp( buf, L"{" )) return FALSE;
+        if (!(str = check_script_key( str, root_keys[i].key, buf, ARRAY_SIZE(buf) ))) return FALSE;
+        if (!(str = get_script_word( str, buf, ARRAY_SIZE(buf) ))) return FALSE;
+    }
+    return TRUE;
+}
+
+struct registration_check
+{
+    const WCHAR *module;
+    const WCHAR *system_root;
+    BOOL         present;
+};
+
+static BOOL CALLBACK check_resource( HMODULE module, LPCWSTR type, LPWSTR name, LONG_PTR arg )
+{
+    struct registration_check *check = (struct registration_check *)arg;
+    WCHAR *script, *expanded = NULL;
+
+    if ((script = load_registry_script( module, type, name )))
+        expanded = expand_registry_script( script, check->module, check->system_root );
+    check->present = expanded && check_registry_script( expanded );
+    free( expanded );
+    free( script );
+    return check->present;
+}
+
+static BOOL CALLBACK checksum_resource( HMODULE module, LPCWSTR type, LPWSTR name, LONG_PTR arg )
+{
+    DWORD *crc = (DWORD *)arg;
+    HRSRC rsrc = FindResourceW( module, name, type );
+    const BYTE *data = LoadResource( module, rsrc );
+
+    if (!data) return FALSE;
+    *crc = RtlComputeCrc32( *crc, data, SizeofResource( module, rsrc ));
+    return TRUE;
+}
+
+/* compute a checksum of the registry scripts of a dll and of the replacements applied to them */
+static DWORD get_registration_checksum( HMODULE module, const WCHAR *name, const WCHAR *system_root )
+{
+    DWORD crc = 0;
+
+    crc = RtlComputeCrc32( crc, (const BYTE *)name, wcslen( name ) * sizeof(WCHAR) );
+    crc = RtlComputeCrc32( crc, (const BYTE *)system_root, wcslen( system_root ) * sizeof(WCHAR) );
+    EnumResourceNamesW( module, L"WINE_REGISTRY", checksum_resource, (LONG_PTR)&crc );
+    return crc;
+}
+
+/* check if the same registry scripts have already been applied for that dll,
+ * and that the keys they created haven't been removed or changed since then */
+static BOOL is_dll_registered( HMODULE module, const WCHAR *name, const WCHAR *system_root, DWORD crc )
+{
+    struct registration_check check = { name, system_root, TRUE };
+    DWORD value, type, size = sizeof(value);
+
+    if (!registered_key &&
+        RegCreateKeyExW( HKEY_LOCAL_MACHINE, L"Software\\Wine\\Registered Dlls", 0, NULL, 0,
+                         KEY_QUERY_VALUE | KEY_SET_VALUE, NULL, &registered_key, NULL ))
+        return FALSE;
+    if (RegQueryValueExW( registered_key, name, NULL, &type, (BYTE *)&value, &size )) return FALSE;
+    if (type != REG_DWORD || value != crc) return FALSE;
+    EnumResourceNamesW( module, L"WINE_REGISTRY", check_resource, (LONG_PTR)&check );
+    return check.present;
+}
+
 static void register_fake_dll( const WCHAR *name, const void *data, size_t size, struct list *delay_copy )
 {
     const IMAGE_RESOURCE_DIRECTORY *resdir;
@@ -849,6 +1142,7 @@ static void register_fake_dll( const WCHAR *name, const void *data, size_t size,
     struct dll_data dll_data = { delay_copy, name, 0 };
     WCHAR buffer[MAX_PATH];
     const WCHAR *p;
+    DWORD crc;
 
     if (!(p = wcsrchr( name, '\\' ))) p = name;
     else p++;
@@ -858,6 +1152,15 @@ static void register_fake_dll( const WCHAR *name, const void *data, size_t size,
     info.Type = (ULONG_PTR)L"WINE_REGISTRY";
     if (LdrFindResourceDirectory_U( module, &info, 1, &resdir )) return;
 
+    /* skip running the scripts again when updating the prefix if they didn't change */
+    GetEnvironmentVariableW( L"SystemRoot", buffer, ARRAY_SIZE(buffer) );
+    crc = get_registration_checksum( module, name, buffer );
+    if (is_dll_registered( module, name, buffer, crc ))
+    {
+        TRACE( "%s already registered\n", debugstr_w(name) );
+        return;
+    }
+
     if (!registrar)
     {
         HRESULT (WINAPI *pAtlCreateRegistrar)(IRegistrar**);
@@ -878,10 +1181,11 @@ static void register_fake_dll( const WCHAR *name, const void *data, size_t size,
     TRACE( "registering %s\n", debugstr_w(name) );
     IRegistrar_ClearReplacements( registrar );
     IRegistrar_AddReplacement( registrar, L"MODULE", name );
-    GetEnvironmentVariableW( L"SystemRoot", buffer, ARRAY_SIZE(buffer) );
     IRegistrar_AddReplacement( registrar, L"SystemRoot", buffer );
     EnumResourceNamesW( module, L"WINE_REGISTRY", register_resource, (LONG_PTR)&hr );
     if (FAILED(hr)) ERR( "failed to register %s: %lx\n", debugstr_w(name), hr );
+    else if (registered_key)
+        RegSetValueExW( registered_key, name, 0, REG_DWORD, (const BYTE *)&crc, sizeof(crc) );
 }
 
 /* copy a fake dll file to the dest directory */
@@ -907,7 +1211,12 @@ static int install_fake_dll( WCHAR *dest, WCHAR *file, BOOL delete, struct list
     destname[len] = 0;
     if (!add_handled_dll( destname )) ret = -1;
 
-    if (ret != -1)
+    if (ret != -1 && !delete && len == end - name && link_dest_file( dest, file ))
+    {
+        TRACE( "%s -> %s (linked)\n", debugstr_w(file), debugstr_w(dest) );
+        register_fake_dll( dest, data, size, delay_copy );
+    }
+    else if (ret != -1)
     {
         HANDLE h = create_dest_file( dest, delete );
 
@@ -940,7 +1249,7 @@ static void delay_copy_files( struct list *delay_copy )
     {
         list_remove( &copy->entry );
         ret = read_file( copy->src, &data, &size );
-        if (ret != 1)
+        if (ret != 1 || link_dest_file( copy->dest, copy->src ))
         {
             free( copy );
             continue;
@@ -1103,4 +1412,6 @@ void cleanup_fake_dlls(void)
     handled_count = handled_total = 0;
     if (registrar) IRegistrar_Release( registrar );
     registrar = NULL;
+    if (registered_key) RegCloseKey( registered_key );
+    registered_key = NULL;
 }
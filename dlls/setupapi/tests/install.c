@@ -2134,6 +2134,69 @@ static void test_start_copy(void)
     delete_file("dst/");
 }
 
+static void test_fake_dll_registration(void)
+{
+    static const char inf_data[] = "[Version]\n"
+            "Signature=\"$Chicago$\"\n"
+            "[DefaultInstall]\n"
+            "WineFakeDlls=fake_dlls_section\n"
+            "[fake_dlls_section]\n"
+            "11,,itss.dll\n";
+    static const char clsid_key[] = "CLSID\\{9d148290-b9c8-11d0-a4cc-0000f80149f6}\\InprocServer32";
+
+    char path[MAX_PATH], value[MAX_PATH];
+    DWORD size;
+    HINF hinf;
+    BOOL ret;
+    HKEY key;
+    LONG l;
+
+    if (!winetest_platform_is_wine)
+    {
+        skip("WineFakeDlls is a Wine extension.\n");
+        return;
+    }
+
+    create_inf_file("test.inf", inf_data);
+    sprintf(path, "%s\\test.inf", CURR_DIR);
+    hinf = SetupOpenInfFileA(path, NULL, INF_STYLE_WIN4, NULL);
+    ok(hinf != INVALID_HANDLE_VALUE, "Failed to open INF file, error %#lx.\n", GetLastError());
+
+    ret = SetupInstallFromInfSectionA(NULL, hinf, "DefaultInstall", 0, NULL, NULL, 0, NULL, NULL, NULL, NULL);
+    ok(ret, "Failed to install, error %#lx.\n", GetLastError());
+
+    /* a deleted key is registered again */
+    l = RegDeleteTreeA(HKEY_CLASSES_ROOT, clsid_key);
+    ok(!l, "Got error %lu.\n", l);
+
+    ret = SetupInstallFromInfSectionA(NULL, hinf, "DefaultInstall", 0, NULL, NULL, 0, NULL, NULL, NULL, NULL);
+    ok(ret, "Failed to install, error %#lx.\n", GetLastError());
+
+    l = RegOpenKeyA(HKEY_CLASSES_ROOT, clsid_key, &key);
+    ok(!l, "Got error %lu.\n", l);
+    size = sizeof(value);
+    l = RegQueryValueExA(key, "ThreadingModel", NULL, NULL, (BYTE *)value, &size);
+    ok(!l, "Got error %lu.\n", l);
+    ok(!strcmp(value, "Both"), "Got value %s.\n", debugstr_a(value));
+
+    /* so is an overwritten value */
+    l = RegSetValueExA(key, "ThreadingModel", 0, REG_SZ, (const BYTE *)"Apartment", sizeof("Apartment"));
+    ok(!l, "Got error %lu.\n", l);
+
+    ret = SetupInstallFromInfSectionA(NULL, hinf, "DefaultInstall", 0, NULL, NULL, 0, NULL, NULL, NULL, NULL);
+    ok(ret, "Failed to install, error %#lx.\n", GetLastError());
+
+    size = sizeof(value);
+    l = RegQueryValueExA(key, "ThreadingModel", NULL, NULL, (BYTE *)value, &size);
+    ok(!l, "Got error %lu.\n", l);
+    ok(!strcmp(value, "Both"), "Got value %s.\n", debugstr_a(value));
+    RegCloseKey(key);
+
+    SetupCloseInfFile(hinf);
+    ret = DeleteFileA("test.inf");
+    ok(ret, "Failed to delete INF file, error %lu.\n", GetLastError());
+}
+
 static void test_register_dlls(void)
 {
     static const char inf_data[] = "[Version]\n"
@@ -2501,6 +2564,7 @@ START_TEST(install)
     test_install_file();
     test_start_copy();
     test_register_dlls();
+    test_fake_dll_registration();
     test_rename();
     test_append_reg();
 
@@ -22,6 +22,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <math.h>
 #include <inttypes.h>
@@ -820,6 +821,14 @@ static void test_printf_fp(void)
         { "%.0f", 1.5, { "2" }},
         { "%.0f", 2.5, { "3", NULL, NULL, NULL, "2" }, {NULL, NULL, NULL, NULL, "3" }},
         { "%g", 9.999999999999999e-5, { "0.0001" }},
+        { "%.16e", 1e23, { "9.9999999999999992e+22", NULL, "9.9999999999999992e+022" }},
+        { "%.17g", 0.1, { "0.10000000000000001" }},
+        { "%g", 1e-300, { "1e-300" }},
+        { "%.3e", 9.9995, { "9.999e+00", NULL, "9.999e+000" }},
+        { "%.2f", 1.005, { "1.00" }},
+        { "%.6e", 4.9406564584124654e-324, { "4.940656e-324", NULL, "4.940656e-324" }},
+        { "%.1f", 0.95, { "0.9" }},
+        { "%.10g", 2.0 / 3.0, { "0.6666666667" }},
     };
 
     const char *res = NULL;
@@ -845,6 +854,69 @@ static void test_printf_fp(void)
     }
 }
 
+static void test_printf_fp_roundtrip(void)
+{
+    unsigned __int64 bits, n, scaled, ipart, fpart, rest, half;
+    unsigned int seed = 0x1234, i, j, k, prec;
+    char buf[64], expect[64];
+    double d, ret;
+
+    /* Shortest representation that is guaranteed to round-trip. */
+    for (i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        bits = seed;
+        seed = seed * 1103515245 + 12345;
+        bits = (bits << 32) | seed;
+        memcpy(&d, &bits, sizeof(d));
+        if (!isfinite(d)) continue;
+
+        vsprintf_wrapper(0, buf, sizeof(buf), "%.17g", d);
+        ret = strtod(buf, NULL);
+        if (memcmp(&ret, &d, sizeof(d)))
+        {
+            ok(0, "%#I64x) %s round-trips to %.17g\n", bits, buf, ret);
+            break;
+        }
+    }
+
+    /* n/2^k has exactly k decimal places, compare rounding to fewer places. */
+    for (i = 0; i < 20000; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        n = seed;
+        seed = seed * 1103515245 + 12345;
+        n = (n << 8) | (seed >> 24);
+        k = 1 + (seed >> 8) % 8;
+        prec = (seed >> 16) % k;
+        d = ldexp(n, -k);
+
+        scaled = n;
+        for (j = 0; j < k; j++) scaled *= 5;
+        for (half = 1, j = 0; j < k - prec; j++) half *= 10;
+        rest = scaled % half;
+        scaled /= half;
+        half /= 2;
+        if (rest == half) continue;
+        if (rest > half) scaled++;
+
+        for (ipart = scaled, j = 0; j < prec; j++) ipart /= 10;
+        for (fpart = 1, j = 0; j < prec; j++) fpart *= 10;
+        fpart = scaled % fpart;
+        if (prec)
+            sprintf(expect, "%I64u.%0*I64u", ipart, prec, fpart);
+        else
+            sprintf(expect, "%I64u", ipart);
+
+        vsprintf_wrapper(0, buf, sizeof(buf), "%.*f", prec, d);
+        if (strcmp(buf, expect))
+        {
+            ok(0, "%.17g, %u) buf = %s, expected %s\n", d, prec, buf, expect);
+            break;
+        }
+    }
+}
+
 static void test_printf_width_specification(void)
 {
     int r;
@@ -880,5 +952,6 @@ START_TEST(printf)
     test_printf_c99();
     test_printf_natural_string();
     test_printf_fp();
+    test_printf_fp_roundtrip();
     test_printf_width_specification();
 }
@@ -1472,6 +1472,47 @@ static void resolve_labels(compile_ctx_t *ctx, unsigned off)
     ctx->labels_cnt = 0;
 }
 
+/* Bind reads of local variables and arguments to their slots, so that they
+ * don't need to be looked up by name at run time. */
+static void resolve_locals(compile_ctx_t *ctx, function_t *func)
+{
+    const WCHAR *name;
+    instr_t *instr;
+    unsigned i;
+
+    for(instr = ctx->code->instrs+func->code_off; instr < ctx->code->instrs+ctx->instr_cnt; instr++) {
+        if(instr->op == OP_ident) {
+            /* the function name refers to its return value */
+            if((func->type == FUNC_FUNCTION || func->type == FUNC_PROPGET)
+               && !wcsicmp(instr->arg1.bstr, func->name))
+                continue;
+        }else if(instr->op != OP_icall || instr->arg2.uint) {
+            continue;
+        }
+
+        name = instr->arg1.bstr;
+
+        for(i = 0; i < func->var_cnt; i++) {
+            if(!wcsicmp(func->vars[i].name, name))
+                break;
+        }
+        if(i < func->var_cnt) {
+            instr->op = OP_local;
+            instr->arg1.lng = i;
+            continue;
+        }
+
+        for(i = 0; i < func->arg_cnt; i++) {
+            if(!wcsicmp(func->args[i].name, name))
+                break;
+        }
+        if(i < func->arg_cnt) {
+            instr->op = OP_local;
+            instr->arg1.lng = -(int)i - 1;
+        }
+    }
+}
+
 static HRESULT fill_array_desc(compile_ctx_t *ctx, dim_decl_t *dim_decl, array_desc_t *array_desc)
 {
     unsigned dim_cnt = 0, i;
@@ -1563,6 +1604,9 @@ static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *f
         assert(i == func->var_cnt);
     }
 
+    if(func->type != FUNC_GLOBAL)
+        resolve_locals(ctx, func);
+
     if(func->array_cnt) {
         unsigned array_id = 0;
         dim_decl_t *dim_decl;
@@ -1846,15 +1890,8 @@ static BOOL lookup_script_identifier(compile_ctx_t *ctx, script_ctx_t *script, c
     for(c = 0; c < ARRAY_SIZE(contexts); c++) {
         if(!contexts[c]) continue;
 
-        for(i = 0; i < contexts[c]->global_vars_cnt; i++) {
-            if(!wcsicmp(contexts[c]->global_vars[i]->name, identifier))
-                return TRUE;
-        }
-
-        for(i = 0; i < contexts[c]->global_funcs_cnt; i++) {
-            if(!wcsicmp(contexts[c]->global_funcs[i]->name, identifier))
-                return TRUE;
-        }
+        if(find_global_var(contexts[c], identifier) || find_global_func(contexts[c], identifier))
+            return TRUE;
 
         for(class = contexts[c]->classes; class; class = class->next) {
             if(!wcsicmp(class->name, identifier))
@@ -842,6 +842,7 @@ static HRESULT WINAPI ScriptTypeInfo_GetIDsOfNames(ITypeInfo *iface, LPOLESTR *r
 {
     ScriptTypeInfo *This = ScriptTypeInfo_from_ITypeInfo(iface);
     ITypeInfo *disp_typeinfo;
+    dynamic_var_t *var;
     const WCHAR *name;
     HRESULT hr = S_OK;
     int i, j, arg;
@@ -874,10 +875,9 @@ static HRESULT WINAPI ScriptTypeInfo_GetIDsOfNames(ITypeInfo *iface, LPOLESTR *r
         return hr;
     }
 
-    for (i = 0; i < This->num_vars; i++)
+    if ((var = find_global_var(This->disp, name)) && var->index < This->num_vars)
     {
-        if (wcsicmp(name, This->disp->global_vars[i]->name)) continue;
-        pMemId[0] = i + 1;
+        pMemId[0] = var->index + 1;
         return S_OK;
     }
 
@@ -1153,6 +1153,7 @@ static HRESULT WINAPI ScriptTypeComp_Bind(ITypeComp *iface, LPOLESTR szName, ULO
     UINT flags = wFlags ? wFlags : ~0;
     ITypeInfo *disp_typeinfo;
     ITypeComp *disp_typecomp;
+    dynamic_var_t *var;
     HRESULT hr;
     UINT i;
 
@@ -1176,12 +1177,11 @@ static HRESULT WINAPI ScriptTypeComp_Bind(ITypeComp *iface, LPOLESTR szName, ULO
         return S_OK;
     }
 
-    for (i = 0; i < This->num_vars; i++)
+    if ((var = find_global_var(This->disp, szName)) && var->index < This->num_vars)
     {
-        if (wcsicmp(szName, This->disp->global_vars[i]->name)) continue;
         if (!(flags & INVOKE_PROPERTYGET)) return TYPE_E_TYPEMISMATCH;
 
-        hr = ITypeInfo_GetVarDesc(&This->ITypeInfo_iface, i, &pBindPtr->lpvardesc);
+        hr = ITypeInfo_GetVarDesc(&This->ITypeInfo_iface, var->index, &pBindPtr->lpvardesc);
         if (FAILED(hr)) return hr;
 
         *pDescKind = DESCKIND_VARDESC;
@@ -1397,25 +1397,22 @@ static HRESULT WINAPI ScriptDisp_Invoke(IDispatchEx *iface, DISPID dispIdMember,
 static HRESULT WINAPI ScriptDisp_GetDispID(IDispatchEx *iface, BSTR bstrName, DWORD grfdex, DISPID *pid)
 {
     ScriptDisp *This = ScriptDisp_from_IDispatchEx(iface);
-    unsigned i;
+    dynamic_var_t *var;
+    global_func_t *func;
 
     TRACE("(%p)->(%s %lx %p)\n", This, debugstr_w(bstrName), grfdex, pid);
 
     if(!This->ctx)
         return E_UNEXPECTED;
 
-    for(i = 0; i < This->global_vars_cnt; i++) {
-        if(!wcsicmp(This->global_vars[i]->name, bstrName)) {
-            *pid = i + 1;
-            return S_OK;
-        }
+    if((var = find_global_var(This, bstrName))) {
+        *pid = var->index + 1;
+        return S_OK;
     }
 
-    for(i = 0; i < This->global_funcs_cnt; i++) {
-        if(!wcsicmp(This->global_funcs[i]->name, bstrName)) {
-            *pid = i + 1 + DISPID_FUNCTION_MASK;
-            return S_OK;
-        }
+    if((func = find_global_func(This, bstrName))) {
+        *pid = func->index + 1 + DISPID_FUNCTION_MASK;
+        return S_OK;
     }
 
     *pid = -1;
@@ -1542,6 +1539,28 @@ static IDispatchExVtbl ScriptDispVtbl = {
     ScriptDisp_GetNameSpaceParent
 };
 
+static int global_var_compare(const void *key, const struct rb_entry *entry)
+{
+    return wcsicmp(key, RB_ENTRY_VALUE(entry, const dynamic_var_t, entry)->name);
+}
+
+static int global_func_compare(const void *key, const struct rb_entry *entry)
+{
+    return wcsicmp(key, RB_ENTRY_VALUE(entry, const global_func_t, entry)->name);
+}
+
+dynamic_var_t *find_global_var(ScriptDisp *script_disp, const WCHAR *name)
+{
+    struct rb_entry *entry = rb_get(&script_disp->global_vars_tree, name);
+    return entry ? RB_ENTRY_VALUE(entry, dynamic_var_t, entry) : NULL;
+}
+
+global_func_t *find_global_func(ScriptDisp *script_disp, const WCHAR *name)
+{
+    struct rb_entry *entry = rb_get(&script_disp->global_funcs_tree, name);
+    return entry ? RB_ENTRY_VALUE(entry, global_func_t, entry) : NULL;
+}
+
 HRESULT create_script_disp(script_ctx_t *ctx, ScriptDisp **ret)
 {
     ScriptDisp *script_disp;
@@ -1554,6 +1573,8 @@ HRESULT create_script_disp(script_ctx_t *ctx, ScriptDisp **ret)
     script_disp->ref = 1;
     script_disp->ctx = ctx;
     heap_pool_init(&script_disp->heap);
+    rb_init(&script_disp->global_vars_tree, global_var_compare);
+    rb_init(&script_disp->global_funcs_tree, global_func_compare);
     script_disp->rnd = 0x50000;
 
     *ret = script_disp;
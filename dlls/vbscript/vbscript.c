@@ -96,6 +96,7 @@ static HRESULT exec_global_code(script_ctx_t *ctx, vbscode_t *code, VARIANT *res
     ScriptDisp *obj = ctx->script_obj;
     function_t *func_iter, **new_funcs;
     dynamic_var_t *var, **new_vars;
+    global_func_t *func;
     IServiceProvider *prev_caller;
     size_t cnt, i;
     HRESULT hres;
@@ -148,24 +149,29 @@ static HRESULT exec_global_code(script_ctx_t *ctx, vbscode_t *code, VARIANT *res
         var->is_const = FALSE;
         var->array = NULL;
 
+        var->index = obj->global_vars_cnt + i;
         obj->global_vars[obj->global_vars_cnt + i] = var;
+        rb_put(&obj->global_vars_tree, var->name, &var->entry);
     }
 
     obj->global_vars_cnt += code->main_code.var_cnt;
 
     for (func_iter = code->funcs; func_iter; func_iter = func_iter->next)
     {
-        for (i = 0; i < obj->global_funcs_cnt; i++)
+        if ((func = find_global_func(obj, func_iter->name)))
         {
-            if (!wcsicmp(obj->global_funcs[i]->name, func_iter->name))
-            {
-                /* global function already exists, replace it */
-                obj->global_funcs[i] = func_iter;
-                break;
-            }
+            /* global function already exists, replace it */
+            obj->global_funcs[func->index] = func_iter;
+            func->name = func_iter->name;
+            continue;
         }
-        if (i == obj->global_funcs_cnt)
-            obj->global_funcs[obj->global_funcs_cnt++] = func_iter;
+
+        if (!(func = heap_pool_alloc(&obj->heap, sizeof(*func))))
+            return E_OUTOFMEMORY;
+        func->name = func_iter->name;
+        func->index = obj->global_funcs_cnt;
+        obj->global_funcs[obj->global_funcs_cnt++] = func_iter;
+        rb_put(&obj->global_funcs_tree, func->name, &func->entry);
     }
 
     if (code->classes)
@@ -32,6 +32,7 @@
 #include "vbscript_defs.h"
 
 #include "wine/list.h"
+#include "wine/rbtree.h"
 
 typedef struct {
     void **blocks;
@@ -113,12 +114,20 @@ struct _vbdisp_t {
 
 typedef struct _dynamic_var_t {
     struct _dynamic_var_t *next;
+    struct rb_entry entry;
+    size_t index;
     VARIANT v;
     const WCHAR *name;
     BOOL is_const;
     SAFEARRAY *array;
 } dynamic_var_t;
 
+typedef struct {
+    struct rb_entry entry;
+    const WCHAR *name;
+    size_t index;
+} global_func_t;
+
 typedef struct {
     IDispatchEx IDispatchEx_iface;
     LONG ref;
@@ -126,10 +135,12 @@ typedef struct {
     dynamic_var_t **global_vars;
     size_t global_vars_cnt;
     size_t global_vars_size;
+    struct rb_tree global_vars_tree;
 
     function_t **global_funcs;
     size_t global_funcs_cnt;
     size_t global_funcs_size;
+    struct rb_tree global_funcs_tree;
 
     class_desc_t *classes;
 
@@ -167,6 +178,8 @@ HRESULT disp_propput(script_ctx_t*,IDispatch*,DISPID,WORD,DISPPARAMS*);
 HRESULT get_disp_value(script_ctx_t*,IDispatch*,VARIANT*);
 void collect_objects(script_ctx_t*);
 HRESULT create_script_disp(script_ctx_t*,ScriptDisp**);
+dynamic_var_t *find_global_var(ScriptDisp*,const WCHAR*);
+global_func_t *find_global_func(ScriptDisp*,const WCHAR*);
 
 HRESULT to_int(VARIANT*,int*);
 
@@ -264,6 +277,7 @@ typedef enum {
     X(jmp,            0, ARG_ADDR,    0)          \
     X(jmp_false,      0, ARG_ADDR,    0)          \
     X(jmp_true,       0, ARG_ADDR,    0)          \
+    X(local,          1, ARG_INT,     0)          \
     X(lt,             1, 0,           0)          \
     X(lteq,           1, 0,           0)          \
     X(mcall,          1, ARG_BSTR,    ARG_UINT)   \
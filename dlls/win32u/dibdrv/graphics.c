@@ -47,10 +47,16 @@ enum glyph_type
 #define GLYPH_CACHE_PAGE_SIZE  0x100
 #define GLYPH_CACHE_PAGES      (0x10000 / GLYPH_CACHE_PAGE_SIZE)
 
+/* unused fonts are kept around as long as their glyphs fit in the memory budget */
+#define FONT_CACHE_MIN_UNUSED  5
+#define FONT_CACHE_MAX_UNUSED  64
+#define FONT_CACHE_MAX_SIZE    (8 * 1024 * 1024)
+
 struct cached_font
 {
     struct list           entry;
     LONG                  ref;
+    LONG                  size;   /* total size of the cached glyphs */
     DWORD                 hash;
     LOGFONTW              lf;
     XFORM                 xform;
@@ -551,10 +557,27 @@ static int font_cache_cmp( const struct cached_font *p1, const struct cached_fon
     return ret;
 }
 
+static void free_cached_glyphs( struct cached_font *font )
+{
+    UINT i, j, k;
+
+    for (i = 0; i < GLYPH_NBTYPES; i++)
+    {
+        for (j = 0; j < GLYPH_CACHE_PAGES; j++)
+        {
+            if (!font->glyphs[i][j]) continue;
+            for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
+                free( font->glyphs[i][j][k] );
+            free( font->glyphs[i][j] );
+        }
+    }
+}
+
 static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 {
     struct cached_font font, *ptr, *last_unused = NULL;
-    UINT i = 0, j, k;
+    SIZE_T unused_size = 0;
+    UINT i = 0;
 
     NtGdiExtGetObjectW( hfont, sizeof(font.lf), &font.lf );
     font.xform = dc->xformWorld2Vport;
@@ -581,23 +604,17 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
         if (!ptr->ref)
         {
             i++;
+            unused_size += ptr->size;
             last_unused = ptr;
         }
     }
 
-    if (i > 5)  /* keep at least 5 of the most-recently used fonts around */
+    /* keep at least a few of the most-recently used fonts around, and more of them
+     * as long as their glyphs don't use too much memory */
+    if (i > FONT_CACHE_MAX_UNUSED || (i > FONT_CACHE_MIN_UNUSED && unused_size > FONT_CACHE_MAX_SIZE))
     {
         ptr = last_unused;
-        for (i = 0; i < GLYPH_NBTYPES; i++)
-        {
-            for (j = 0; j < GLYPH_CACHE_PAGES; j++)
-            {
-                if (!ptr->glyphs[i][j]) continue;
-                for (k = 0; k < GLYPH_CACHE_PAGE_SIZE; k++)
-                    free( ptr->glyphs[i][j][k] );
-                free( ptr->glyphs[i][j] );
-            }
-        }
+        free_cached_glyphs( ptr );
         list_remove( &ptr->entry );
     }
     else if (!(ptr = malloc( sizeof(*ptr) )))
@@ -608,6 +625,7 @@ static struct cached_font *add_cached_font( DC *dc, HFONT hfont, UINT aa_flags )
 
     *ptr = font;
     ptr->ref = 1;
+    ptr->size = 0;
     memset( ptr->glyphs, 0, sizeof(ptr->glyphs) );
 done:
     list_add_head( &font_cache, &ptr->entry );
@@ -622,7 +640,7 @@ void release_cached_font( struct cached_font *font )
 }
 
 static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT index, UINT flags,
-                                              struct cached_glyph *glyph )
+                                              struct cached_glyph *glyph, UINT size )
 {
     struct cached_glyph *ret;
     enum glyph_type type = (flags & ETO_GLYPH_INDEX) ? GLYPH_INDEX : GLYPH_WCHAR;
@@ -643,7 +661,11 @@ static struct cached_glyph *add_cached_glyph( struct cached_font *font, UINT ind
             free( ptr );
     }
     ret = InterlockedCompareExchangePointer( (void **)&font->glyphs[type][page][entry], glyph, NULL );
-    if (!ret) ret = glyph;
+    if (!ret)
+    {
+        InterlockedExchangeAdd( &font->size, FIELD_OFFSET( struct cached_glyph, bits[size] ));
+        ret = glyph;
+    }
     else free( glyph );
     return ret;
 }
@@ -804,7 +826,7 @@ static struct cached_glyph *cache_glyph_bitmap( DC *dc, struct cached_font *font
 
 done:
     glyph->metrics = metrics;
-    return add_cached_glyph( font, index, flags, glyph );
+    return add_cached_glyph( font, index, flags, glyph, size );
 }
 
 static void render_string( DC *dc, dib_info *dib, struct cached_font *font, INT x, INT y,
@@ -1426,12 +1426,157 @@ static void load_font_list_from_cache(void)
     }
 }
 
+/* The font list index is a single registry value holding all the cached faces,
+ * so that processes can load the whole cache at once instead of walking
+ * the per-family keys. It is built by the process that creates the cache,
+ * and discarded as soon as the cache gets modified. */
+
+struct cached_index_entry
+{
+    DWORD                   size;        /* size of the entry, including the names */
+    DWORD                   index;
+    DWORD                   flags;
+    DWORD                   ntmflags;
+    DWORD                   version;
+    BOOL                    scalable;
+    struct bitmap_font_size bitmap_size;
+    FONTSIGNATURE           fs;
+    WCHAR                   names[1];
+    /* family name, second name, style name, full name, file name */
+};
+
+static const WCHAR font_cache_indexW[] = {'I','n','d','e','x',0};
+static BOOL font_cache_index_valid;
+
+static void invalidate_font_list_index(void)
+{
+    if (!font_cache_index_valid) return;
+    reg_delete_value( wine_fonts_cache_key, font_cache_indexW );
+    font_cache_index_valid = FALSE;
+}
+
+static BOOL load_font_list_from_index(void)
+{
+    UNICODE_STRING nameW = RTL_CONSTANT_STRING( font_cache_indexW );
+    KEY_VALUE_PARTIAL_INFORMATION *info;
+    const struct cached_index_entry *entry;
+    const WCHAR *family_name, *second_name, *style, *full_name, *file;
+    struct gdi_font_family *family;
+    struct gdi_font_face *face;
+    ULONG size, pos, count = 0;
+    NTSTATUS status;
+
+    status = NtQueryValueKey( wine_fonts_cache_key, &nameW, KeyValuePartialInformation, NULL, 0, &size );
+    if (status != STATUS_BUFFER_TOO_SMALL && status != STATUS_BUFFER_OVERFLOW) return FALSE;
+    if (!(info = malloc( size ))) return FALSE;
+    if (NtQueryValueKey( wine_fonts_cache_key, &nameW, KeyValuePartialInformation, info, size, &size ) ||
+        info->Type != REG_BINARY)
+    {
+        free( info );
+        return FALSE;
+    }
+
+    for (pos = 0; pos + sizeof(*entry) <= info->DataLength; pos += entry->size)
+    {
+        entry = (const struct cached_index_entry *)(info->Data + pos);
+        if (entry->size < sizeof(*entry) || entry->size > info->DataLength - pos ||
+            entry->size % sizeof(DWORD) ||
+            *(const WCHAR *)((const char *)entry + entry->size - sizeof(WCHAR)))
+        {
+            WARN( "invalid entry at offset %u, ignoring the rest of the index\n", (int)pos );
+            break;
+        }
+        family_name = entry->names;
+        second_name = family_name + lstrlenW( family_name ) + 1;
+        style       = second_name + lstrlenW( second_name ) + 1;
+        full_name   = style + lstrlenW( style ) + 1;
+        file        = full_name + lstrlenW( full_name ) + 1;
+
+        if ((family = find_family_from_name( family_name ))) family->refcount++;
+        else if (!(family = create_family( family_name, second_name ))) continue;
+
+        if ((face = create_face( family, style, full_name, file, NULL, 0, entry->index, entry->fs,
+                                 entry->ntmflags, entry->version, entry->flags,
+                                 entry->scalable ? NULL : &entry->bitmap_size )))
+        {
+            release_face( face );
+            count++;
+        }
+        release_family( family );
+    }
+
+    TRACE( "loaded %u faces from the index\n", (int)count );
+    free( info );
+    return font_cache_index_valid = TRUE;
+}
+
+static void save_font_list_index(void)
+{
+    struct gdi_font_family *family;
+    struct gdi_font_face *face;
+    struct cached_index_entry *entry;
+    char *data = NULL, *new_data;
+    const WCHAR *names[5];
+    SIZE_T size = 0, alloc = 0, entry_size, len;
+    WCHAR *ptr;
+    unsigned int i;
+
+    WINE_RB_FOR_EACH_ENTRY( family, &family_name_tree, struct gdi_font_family, name_entry )
+    {
+        LIST_FOR_EACH_ENTRY( face, &family->faces, struct gdi_font_face, entry )
+        {
+            if (!(face->flags & ADDFONT_ADD_TO_CACHE)) continue;
+
+            names[0] = family->family_name;
+            names[1] = family->second_name;
+            names[2] = face->style_name;
+            names[3] = face->full_name;
+            names[4] = face->file;
+
+            entry_size = offsetof( struct cached_index_entry, names );
+            for (i = 0; i < ARRAY_SIZE(names); i++) entry_size += (lstrlenW( names[i] ) + 1) * sizeof(WCHAR);
+            entry_size = (entry_size + sizeof(DWORD) - 1) & ~(sizeof(DWORD) - 1);
+
+            if (size + entry_size > alloc)
+            {
+                alloc = max( alloc * 2, size + entry_size + 4096 );
+                if (!(new_data = realloc( data, alloc ))) goto done;
+                data = new_data;
+            }
+
+            entry = (struct cached_index_entry *)(data + size);
+            memset( entry, 0, entry_size );
+            entry->size     = entry_size;
+            entry->index    = face->face_index;
+            entry->flags    = face->flags;
+            entry->ntmflags = face->ntmFlags;
+            entry->version  = face->version;
+            entry->scalable = face->scalable;
+            entry->fs       = face->fs;
+            if (!face->scalable) entry->bitmap_size = face->size;
+            for (i = 0, ptr = entry->names; i < ARRAY_SIZE(names); i++, ptr += len)
+            {
+                len = lstrlenW( names[i] ) + 1;
+                memcpy( ptr, names[i], len * sizeof(WCHAR) );
+            }
+            size += entry_size;
+        }
+    }
+
+    if (size) font_cache_index_valid = set_reg_value( wine_fonts_cache_key, font_cache_indexW,
+                                                      REG_BINARY, data, size );
+done:
+    free( data );
+}
+
 static void add_face_to_cache( struct gdi_font_face *face )
 {
     HKEY hkey_family, hkey_face;
     DWORD len, buffer[1024];
     struct cached_face *cached = (struct cached_face *)buffer;
 
+    invalidate_font_list_index();
+
     if (!(hkey_family = reg_create_key( wine_fonts_cache_key, face->family->family_name,
                                         lstrlenW( face->family->family_name ) * sizeof(WCHAR),
                                         REG_OPTION_VOLATILE, NULL )))
@@ -1476,6 +1621,8 @@ static void remove_face_from_cache( struct gdi_font_face *face )
 {
     HKEY hkey_family, hkey;
 
+    invalidate_font_list_index();
+
     if (!(hkey_family = reg_open_key( wine_fonts_cache_key, face->family->family_name,
                                       lstrlenW( face->family->family_name ) * sizeof(WCHAR) )))
         return;
@@ -6901,6 +7048,7 @@ UINT font_init(void)
     {
         load_registry_fonts();
         update_external_font_keys();
+        save_font_list_index();
     }
 
     NtReleaseMutant( mutex, NULL );
@@ -6908,7 +7056,7 @@ UINT font_init(void)
     if (disposition != REG_CREATED_NEW_KEY)
     {
         load_registry_fonts();
-        load_font_list_from_cache();
+        if (!load_font_list_from_index()) load_font_list_from_cache();
     }
 
     reorder_font_list();
@@ -771,6 +771,19 @@ void wined3d_cs_emit_present(struct wined3d_cs *cs, struct wined3d_swapchain *sw
 
     wined3d_device_context_submit(&cs->c, WINED3D_CS_QUEUE_DEFAULT);
 
+    if (TRACE_ON(d3d_perf))
+    {
+        const struct wined3d_cs_queue *queue = &cs->queue[WINED3D_CS_QUEUE_DEFAULT];
+        LARGE_INTEGER freq;
+
+        QueryPerformanceFrequency(&freq);
+        TRACE_(d3d_perf)("Frame submitted: %u packets, %u wakeups, %lu bytes queued, "
+                "%u stalls for %.3f ms waiting for free space.\n",
+                cs->stats.packets, cs->stats.wakeups, queue->head - *(volatile ULONG *)&queue->tail,
+                cs->stats.stalls, cs->stats.stall_time * 1000.0 / freq.QuadPart);
+    }
+    memset(&cs->stats, 0, sizeof(cs->stats));
+
     /* Limit input latency by limiting the number of presents that we can get
      * ahead of the worker thread. */
     while (pending >= swapchain->max_frame_latency)
@@ -3223,9 +3236,14 @@ static void wined3d_cs_queue_submit(struct wined3d_cs_queue *queue, struct wined
     TRACE("Queuing op %s at %p.\n", debug_cs_op(*(const enum wined3d_cs_op *)packet->data), packet);
     packet_size = FIELD_OFFSET(struct wined3d_cs_packet, data[packet->size]);
     InterlockedExchange((LONG *)&queue->head, queue->head + packet_size);
+    ++cs->stats.packets;
 
-    if (InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
+    /* The interlocked exchange above is a full barrier, and the CS thread
+     * checks the queue again after setting "waiting_for_event", so we only
+     * need the interlocked operation when the CS thread is about to sleep. */
+    if (*(volatile LONG *)&cs->waiting_for_event && InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
     {
+        ++cs->stats.wakeups;
         if (pNtAlertThreadByThreadId)
             pNtAlertThreadByThreadId((HANDLE)(ULONG_PTR)cs->thread_id);
         else
@@ -3247,8 +3265,10 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
 {
     size_t queue_size = ARRAY_SIZE(queue->data);
     size_t header_size, packet_size, remaining;
+    LARGE_INTEGER stall_start = {{0}}, stall_end;
     struct wined3d_cs_packet *packet;
     ULONG head = queue->head & WINED3D_CS_QUEUE_MASK;
+    unsigned int spin_count = 0;
 
     header_size = FIELD_OFFSET(struct wined3d_cs_packet, data[0]);
     packet_size = FIELD_OFFSET(struct wined3d_cs_packet, data[size]);
@@ -3295,8 +3315,20 @@ static void *wined3d_cs_queue_require_space(struct wined3d_cs_queue *queue, size
         if (new_pos < tail && new_pos)
             break;
 
-        TRACE_(d3d_perf)("Waiting for free space. Head %lu, tail %lu, packet size %Iu.\n",
-                head, tail, packet_size);
+        if (!spin_count)
+        {
+            TRACE_(d3d_perf)("Waiting for free space. Head %lu, tail %lu, packet size %Iu.\n",
+                    head, tail, packet_size);
+            QueryPerformanceCounter(&stall_start);
+            ++cs->stats.stalls;
+        }
+        wined3d_pause(&spin_count);
+    }
+
+    if (spin_count)
+    {
+        QueryPerformanceCounter(&stall_end);
+        cs->stats.stall_time += stall_end.QuadPart - stall_start.QuadPart;
     }
 
     packet = (struct wined3d_cs_packet *)&queue->data[head];
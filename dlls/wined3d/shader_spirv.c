@@ -51,8 +51,14 @@ struct shader_spirv_priv
     const struct wined3d_fragment_pipe_ops *fragment_pipe;
 
     struct shader_spirv_resource_bindings bindings;
+
+    PTP_POOL compile_pool;
+    TP_CALLBACK_ENVIRON compile_environment;
 };
 
+/* Upper bound on the worker threads precompiling shaders for a device. */
+#define SHADER_SPIRV_COMPILE_THREADS_MAX 2
+
 struct shader_spirv_compile_arguments
 {
     union
@@ -75,12 +81,26 @@ struct shader_spirv_graphics_program_variant_vk
     VkShaderModule vk_module;
 };
 
+/* SPIR-V for the most likely variant of a shader, compiled on a thread pool
+ * worker while the shader is being created, so that the first draw or
+ * dispatch using it doesn't have to wait for the full translation. */
+struct shader_spirv_async_compile
+{
+    PTP_WORK work;
+    const struct wined3d_shader *shader;
+    struct shader_spirv_compile_arguments args;
+    struct shader_spirv_resource_bindings bindings;
+    struct vkd3d_shader_code spirv;
+    bool valid;
+};
+
 struct shader_spirv_graphics_program_vk
 {
     struct shader_spirv_graphics_program_variant_vk *variants;
     SIZE_T variants_size, variant_count;
 
     struct vkd3d_shader_scan_descriptor_info descriptor_info;
+    struct shader_spirv_async_compile *async;
 };
 
 struct shader_spirv_compute_program_vk
@@ -91,6 +111,7 @@ struct shader_spirv_compute_program_vk
     VkDescriptorSetLayout vk_set_layout;
 
     struct vkd3d_shader_scan_descriptor_info descriptor_info;
+    struct shader_spirv_async_compile *async;
 };
 
 struct wined3d_shader_spirv_compile_args
@@ -106,6 +127,8 @@ struct wined3d_shader_spirv_shader_interface
     struct vkd3d_shader_transform_feedback_info xfb_info;
 };
 
+static void shader_spirv_resource_bindings_cleanup(struct shader_spirv_resource_bindings *bindings);
+
 static enum vkd3d_shader_visibility vkd3d_shader_visibility_from_wined3d(enum wined3d_shader_type shader_type)
 {
     switch (shader_type)
@@ -227,21 +250,15 @@ static void shader_spirv_init_shader_interface_vk(struct wined3d_shader_spirv_sh
     iface->vkd3d_interface.uav_counter_count = b->uav_counter_count;
 }
 
-static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *context_vk,
-        const struct wined3d_shader_desc *shader_desc, enum wined3d_shader_type shader_type,
-        const struct shader_spirv_compile_arguments *args, const struct shader_spirv_resource_bindings *bindings,
-        const struct wined3d_stream_output_desc *so_desc)
+static bool shader_spirv_compile_spirv(const struct wined3d_shader_desc *shader_desc,
+        enum wined3d_shader_type shader_type, const struct shader_spirv_compile_arguments *args,
+        const struct shader_spirv_resource_bindings *bindings, const struct wined3d_stream_output_desc *so_desc,
+        struct vkd3d_shader_code *spirv)
 {
     struct wined3d_shader_spirv_compile_args compile_args;
     struct wined3d_shader_spirv_shader_interface iface;
-    VkShaderModuleCreateInfo shader_create_info;
     struct vkd3d_shader_compile_info info;
-    const struct wined3d_vk_info *vk_info;
-    struct wined3d_device_vk *device_vk;
-    struct vkd3d_shader_code spirv;
-    VkShaderModule module;
     char *messages;
-    VkResult vr;
     int ret;
 
     shader_spirv_init_shader_interface_vk(&iface, bindings, so_desc);
@@ -259,7 +276,7 @@ static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *con
     info.log_level = VKD3D_SHADER_LOG_WARNING;
     info.source_name = NULL;
 
-    ret = vkd3d_shader_compile(&info, &spirv, &messages);
+    ret = vkd3d_shader_compile(&info, spirv, &messages);
     if (messages && *messages && FIXME_ON(d3d_shader))
     {
         const char *ptr, *end, *line;
@@ -278,29 +295,98 @@ static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *con
     if (ret < 0)
     {
         ERR("Failed to compile DXBC, ret %d.\n", ret);
-        return VK_NULL_HANDLE;
+        return false;
     }
 
-    device_vk = wined3d_device_vk(context_vk->c.device);
-    vk_info = &device_vk->vk_info;
+    return true;
+}
+
+static VkShaderModule shader_spirv_create_module(struct wined3d_context_vk *context_vk,
+        const struct vkd3d_shader_code *spirv)
+{
+    struct wined3d_device_vk *device_vk = wined3d_device_vk(context_vk->c.device);
+    const struct wined3d_vk_info *vk_info = &device_vk->vk_info;
+    VkShaderModuleCreateInfo shader_create_info;
+    VkShaderModule module;
+    VkResult vr;
 
     shader_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
     shader_create_info.pNext = NULL;
     shader_create_info.flags = 0;
-    shader_create_info.codeSize = spirv.size;
-    shader_create_info.pCode = spirv.code;
+    shader_create_info.codeSize = spirv->size;
+    shader_create_info.pCode = spirv->code;
     if ((vr = VK_CALL(vkCreateShaderModule(device_vk->vk_device, &shader_create_info, NULL, &module))) < 0)
     {
-        vkd3d_shader_free_shader_code(&spirv);
         WARN("Failed to create Vulkan shader module, vr %s.\n", wined3d_debug_vkresult(vr));
         return VK_NULL_HANDLE;
     }
 
+    return module;
+}
+
+static VkShaderModule shader_spirv_compile_shader(struct wined3d_context_vk *context_vk,
+        const struct wined3d_shader_desc *shader_desc, enum wined3d_shader_type shader_type,
+        const struct shader_spirv_compile_arguments *args, const struct shader_spirv_resource_bindings *bindings,
+        const struct wined3d_stream_output_desc *so_desc)
+{
+    struct vkd3d_shader_code spirv;
+    VkShaderModule module;
+
+    if (!shader_spirv_compile_spirv(shader_desc, shader_type, args, bindings, so_desc, &spirv))
+        return VK_NULL_HANDLE;
+
+    module = shader_spirv_create_module(context_vk, &spirv);
     vkd3d_shader_free_shader_code(&spirv);
 
     return module;
 }
 
+static void shader_spirv_async_compile_destroy(struct shader_spirv_async_compile *async)
+{
+    if (!async)
+        return;
+
+    WaitForThreadpoolWorkCallbacks(async->work, TRUE);
+    CloseThreadpoolWork(async->work);
+    if (async->valid)
+        vkd3d_shader_free_shader_code(&async->spirv);
+    shader_spirv_resource_bindings_cleanup(&async->bindings);
+    heap_free(async);
+}
+
+/* Returns a module for the precompiled variant if "args" and "bindings"
+ * match it. The precompiled variant is only used once; it is released
+ * either way. If its translation hasn't started yet, it is cancelled, and
+ * the caller compiles the shader itself instead of waiting behind the other
+ * queued translations. */
+static VkShaderModule shader_spirv_async_compile_get_module(struct shader_spirv_async_compile **async,
+        struct wined3d_context_vk *context_vk, const struct shader_spirv_compile_arguments *args,
+        const struct shader_spirv_resource_bindings *bindings, size_t binding_base)
+{
+    struct shader_spirv_async_compile *a = *async;
+    VkShaderModule module = VK_NULL_HANDLE;
+
+    if (!a)
+        return VK_NULL_HANDLE;
+    *async = NULL;
+
+    WaitForThreadpoolWorkCallbacks(a->work, TRUE);
+    if (a->valid && !binding_base && !memcmp(&a->args, args, sizeof(*args))
+            && a->bindings.binding_count <= bindings->binding_count
+            && !memcmp(a->bindings.bindings, bindings->bindings,
+            a->bindings.binding_count * sizeof(*bindings->bindings))
+            && a->bindings.uav_counter_count <= bindings->uav_counter_count
+            && !memcmp(a->bindings.uav_counters, bindings->uav_counters,
+            a->bindings.uav_counter_count * sizeof(*bindings->uav_counters)))
+    {
+        TRACE("Using precompiled SPIR-V for shader %p.\n", a->shader);
+        module = shader_spirv_create_module(context_vk, &a->spirv);
+    }
+    shader_spirv_async_compile_destroy(a);
+
+    return module;
+}
+
 static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphics_program_variant_vk(
         struct shader_spirv_priv *priv, struct wined3d_context_vk *context_vk, struct wined3d_shader *shader,
         const struct wined3d_state *state, const struct shader_spirv_resource_bindings *bindings)
@@ -341,8 +427,14 @@ static struct shader_spirv_graphics_program_variant_vk *shader_spirv_find_graphi
     shader_desc.byte_code = shader->byte_code;
     shader_desc.byte_code_size = shader->byte_code_size;
 
-    if (!(variant_vk->vk_module = shader_spirv_compile_shader(context_vk, &shader_desc, shader_type, &args,
-            bindings, so_desc)))
+    if (!so_desc)
+        variant_vk->vk_module = shader_spirv_async_compile_get_module(&program_vk->async,
+                context_vk, &args, bindings, binding_base);
+    else
+        variant_vk->vk_module = VK_NULL_HANDLE;
+
+    if (!variant_vk->vk_module && !(variant_vk->vk_module = shader_spirv_compile_shader(context_vk,
+            &shader_desc, shader_type, &args, bindings, so_desc)))
         return NULL;
     ++program_vk->variant_count;
 
@@ -356,6 +448,7 @@ static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program
     struct wined3d_device_vk *device_vk = wined3d_device_vk(context_vk->c.device);
     const struct wined3d_vk_info *vk_info = context_vk->vk_info;
     struct shader_spirv_compute_program_vk *program;
+    struct shader_spirv_compile_arguments args;
     struct wined3d_pipeline_layout_vk *layout;
     VkComputePipelineCreateInfo pipeline_info;
     struct wined3d_shader_desc shader_desc;
@@ -370,8 +463,10 @@ static struct shader_spirv_compute_program_vk *shader_spirv_find_compute_program
     shader_desc.byte_code = shader->byte_code;
     shader_desc.byte_code_size = shader->byte_code_size;
 
-    if (!(program->vk_module = shader_spirv_compile_shader(context_vk, &shader_desc, WINED3D_SHADER_TYPE_COMPUTE,
-            NULL, bindings, NULL)))
+    memset(&args, 0, sizeof(args));
+    if (!(program->vk_module = shader_spirv_async_compile_get_module(&program->async, context_vk, &args, bindings, 0))
+            && !(program->vk_module = shader_spirv_compile_shader(context_vk, &shader_desc,
+            WINED3D_SHADER_TYPE_COMPUTE, NULL, bindings, NULL)))
         return NULL;
 
     if (!(layout = wined3d_context_vk_get_pipeline_layout(context_vk,
@@ -593,20 +688,71 @@ static enum wined3d_data_type wined3d_data_type_from_vkd3d(enum vkd3d_shader_res
     }
 }
 
-static bool shader_spirv_resource_bindings_init(struct shader_spirv_resource_bindings *bindings,
-        struct wined3d_shader_resource_bindings *wined3d_bindings,
-        const struct wined3d_state *state, uint32_t shader_mask)
+static bool shader_spirv_resource_bindings_add_shader(struct shader_spirv_resource_bindings *bindings,
+        struct wined3d_shader_resource_bindings *wined3d_bindings, enum wined3d_shader_type shader_type,
+        const struct vkd3d_shader_scan_descriptor_info *descriptor_info)
 {
-    const struct vkd3d_shader_scan_descriptor_info *descriptor_info;
     enum wined3d_shader_descriptor_type wined3d_type;
     enum vkd3d_shader_visibility shader_visibility;
-    enum wined3d_shader_type shader_type;
     VkDescriptorType vk_descriptor_type;
     VkShaderStageFlagBits vk_stage;
-    struct wined3d_shader *shader;
     size_t binding_idx;
     unsigned int i;
 
+    vk_stage = vk_shader_stage_from_wined3d(shader_type);
+    shader_visibility = vkd3d_shader_visibility_from_wined3d(shader_type);
+
+    for (i = 0; i < descriptor_info->descriptor_count; ++i)
+    {
+        const struct vkd3d_shader_descriptor_info *d = &descriptor_info->descriptors[i];
+        uint32_t flags;
+
+        if (d->register_space)
+        {
+            WARN("Unsupported register space %u.\n", d->register_space);
+            return false;
+        }
+
+        if (d->resource_type == VKD3D_SHADER_RESOURCE_BUFFER)
+            flags = VKD3D_SHADER_BINDING_FLAG_BUFFER;
+        else
+            flags = VKD3D_SHADER_BINDING_FLAG_IMAGE;
+
+        vk_descriptor_type = vk_descriptor_type_from_vkd3d(d->type, d->resource_type);
+        if (!shader_spirv_resource_bindings_add_binding(bindings, d->type, vk_descriptor_type,
+                d->register_index, shader_visibility, vk_stage, flags, &binding_idx))
+            return false;
+
+        wined3d_type = wined3d_descriptor_type_from_vkd3d(d->type);
+        if (!wined3d_shader_resource_bindings_add_binding(wined3d_bindings, shader_type,
+                wined3d_type, d->register_index, wined3d_shader_resource_type_from_vkd3d(d->resource_type),
+                wined3d_data_type_from_vkd3d(d->resource_data_type), binding_idx))
+            return false;
+
+        if (d->type == VKD3D_SHADER_DESCRIPTOR_TYPE_UAV
+                && (d->flags & VKD3D_SHADER_DESCRIPTOR_INFO_FLAG_UAV_COUNTER))
+        {
+            if (!shader_spirv_resource_bindings_add_uav_counter_binding(bindings,
+                    d->register_index, shader_visibility, vk_stage, &binding_idx))
+                return false;
+            if (!wined3d_shader_resource_bindings_add_binding(wined3d_bindings,
+                    shader_type, WINED3D_SHADER_DESCRIPTOR_TYPE_UAV_COUNTER, d->register_index,
+                    WINED3D_SHADER_RESOURCE_BUFFER, WINED3D_DATA_UINT, binding_idx))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+static bool shader_spirv_resource_bindings_init(struct shader_spirv_resource_bindings *bindings,
+        struct wined3d_shader_resource_bindings *wined3d_bindings,
+        const struct wined3d_state *state, uint32_t shader_mask)
+{
+    const struct vkd3d_shader_scan_descriptor_info *descriptor_info;
+    enum wined3d_shader_type shader_type;
+    struct wined3d_shader *shader;
+
     bindings->binding_count = 0;
     bindings->uav_counter_count = 0;
     bindings->vk_binding_count = 0;
@@ -631,48 +777,8 @@ static bool shader_spirv_resource_bindings_init(struct shader_spirv_resource_bin
                 bindings->so_stage = WINED3D_SHADER_TYPE_VERTEX;
         }
 
-        vk_stage = vk_shader_stage_from_wined3d(shader_type);
-        shader_visibility = vkd3d_shader_visibility_from_wined3d(shader_type);
-
-        for (i = 0; i < descriptor_info->descriptor_count; ++i)
-        {
-            const struct vkd3d_shader_descriptor_info *d = &descriptor_info->descriptors[i];
-            uint32_t flags;
-
-            if (d->register_space)
-            {
-                WARN("Unsupported register space %u.\n", d->register_space);
-                return false;
-            }
-
-            if (d->resource_type == VKD3D_SHADER_RESOURCE_BUFFER)
-                flags = VKD3D_SHADER_BINDING_FLAG_BUFFER;
-            else
-                flags = VKD3D_SHADER_BINDING_FLAG_IMAGE;
-
-            vk_descriptor_type = vk_descriptor_type_from_vkd3d(d->type, d->resource_type);
-            if (!shader_spirv_resource_bindings_add_binding(bindings, d->type, vk_descriptor_type,
-                    d->register_index, shader_visibility, vk_stage, flags, &binding_idx))
-                return false;
-
-            wined3d_type = wined3d_descriptor_type_from_vkd3d(d->type);
-            if (!wined3d_shader_resource_bindings_add_binding(wined3d_bindings, shader_type,
-                    wined3d_type, d->register_index, wined3d_shader_resource_type_from_vkd3d(d->resource_type),
-                    wined3d_data_type_from_vkd3d(d->resource_data_type), binding_idx))
-                return false;
-
-            if (d->type == VKD3D_SHADER_DESCRIPTOR_TYPE_UAV
-                    && (d->flags & VKD3D_SHADER_DESCRIPTOR_INFO_FLAG_UAV_COUNTER))
-            {
-                if (!shader_spirv_resource_bindings_add_uav_counter_binding(bindings,
-                        d->register_index, shader_visibility, vk_stage, &binding_idx))
-                    return false;
-                if (!wined3d_shader_resource_bindings_add_binding(wined3d_bindings,
-                        shader_type, WINED3D_SHADER_DESCRIPTOR_TYPE_UAV_COUNTER, d->register_index,
-                        WINED3D_SHADER_RESOURCE_BUFFER, WINED3D_DATA_UINT, binding_idx))
-                    return false;
-            }
-        }
+        if (!shader_spirv_resource_bindings_add_shader(bindings, wined3d_bindings, shader_type, descriptor_info))
+            return false;
     }
 
     return true;
@@ -717,6 +823,60 @@ static void shader_spirv_scan_shader(struct wined3d_shader *shader,
     vkd3d_shader_free_messages(messages);
 }
 
+static void CALLBACK shader_spirv_async_compile_cb(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+{
+    struct shader_spirv_async_compile *async = context;
+    const struct wined3d_shader *shader = async->shader;
+    struct wined3d_shader_desc shader_desc;
+
+    shader_desc.byte_code = shader->byte_code;
+    shader_desc.byte_code_size = shader->byte_code_size;
+    async->valid = shader_spirv_compile_spirv(&shader_desc, shader->reg_maps.shader_version.type,
+            &async->args, &async->bindings, NULL, &async->spirv);
+}
+
+/* Pixel shaders always use binding base 0, and their compile arguments
+ * usually have the defaults below; compute shaders don't depend on any other
+ * state. Other stages depend on the bindings of the preceding stages, and
+ * are compiled when they are first used. */
+static struct shader_spirv_async_compile *shader_spirv_async_compile_create(const struct wined3d_shader *shader,
+        const struct vkd3d_shader_scan_descriptor_info *descriptor_info)
+{
+    enum wined3d_shader_type shader_type = shader->reg_maps.shader_version.type;
+    struct wined3d_shader_resource_bindings wined3d_bindings = {0};
+    struct shader_spirv_priv *priv = shader->device->shader_priv;
+    struct shader_spirv_async_compile *async;
+
+    if (shader_type != WINED3D_SHADER_TYPE_PIXEL && shader_type != WINED3D_SHADER_TYPE_COMPUTE)
+        return NULL;
+    if (!priv->compile_pool)
+        return NULL;
+    if (!shader->function || !shader->byte_code_size)
+        return NULL;
+
+    if (!(async = heap_alloc_zero(sizeof(*async))))
+        return NULL;
+    async->shader = shader;
+    if (shader_type == WINED3D_SHADER_TYPE_PIXEL)
+        async->args.u.fs.sample_count = 1;
+
+    if (!shader_spirv_resource_bindings_add_shader(&async->bindings, &wined3d_bindings,
+            shader_type, descriptor_info)
+            || !(async->work = CreateThreadpoolWork(shader_spirv_async_compile_cb, async,
+            &priv->compile_environment)))
+    {
+        heap_free(wined3d_bindings.bindings);
+        shader_spirv_resource_bindings_cleanup(&async->bindings);
+        heap_free(async);
+        return NULL;
+    }
+    heap_free(wined3d_bindings.bindings);
+
+    SubmitThreadpoolWork(async->work);
+
+    return async;
+}
+
 static void shader_spirv_precompile_compute(struct wined3d_shader *shader)
 {
     struct shader_spirv_compute_program_vk *program_vk;
@@ -729,6 +889,7 @@ static void shader_spirv_precompile_compute(struct wined3d_shader *shader)
     }
 
     shader_spirv_scan_shader(shader, &program_vk->descriptor_info);
+    program_vk->async = shader_spirv_async_compile_create(shader, &program_vk->descriptor_info);
 }
 
 static void shader_spirv_precompile(void *shader_priv, struct wined3d_shader *shader)
@@ -751,6 +912,7 @@ static void shader_spirv_precompile(void *shader_priv, struct wined3d_shader *sh
     }
 
     shader_spirv_scan_shader(shader, &program_vk->descriptor_info);
+    program_vk->async = shader_spirv_async_compile_create(shader, &program_vk->descriptor_info);
 }
 
 static void shader_spirv_select(void *shader_priv, struct wined3d_context *context,
@@ -928,6 +1090,7 @@ static void shader_spirv_destroy_compute_vk(struct wined3d_shader *shader)
     shader_spirv_invalidate_contexts_compute_program(&device_vk->d, program);
     wined3d_context_vk_destroy_vk_pipeline(context_vk, program->vk_pipeline, context_vk->current_command_buffer.id);
     VK_CALL(vkDestroyShaderModule(device_vk->vk_device, program->vk_module, NULL));
+    shader_spirv_async_compile_destroy(program->async);
     vkd3d_shader_free_scan_descriptor_info(&program->descriptor_info);
     shader->backend_data = NULL;
     heap_free(program);
@@ -958,6 +1121,7 @@ static void shader_spirv_destroy(struct wined3d_shader *shader)
         VK_CALL(vkDestroyShaderModule(device_vk->vk_device, variant_vk->vk_module, NULL));
     }
     heap_free(program_vk->variants);
+    shader_spirv_async_compile_destroy(program_vk->async);
     vkd3d_shader_free_scan_descriptor_info(&program_vk->descriptor_info);
 
     shader->backend_data = NULL;
@@ -992,6 +1156,21 @@ static HRESULT shader_spirv_alloc(struct wined3d_device *device,
     priv->fragment_pipe = fragment_pipe;
     memset(&priv->bindings, 0, sizeof(priv->bindings));
 
+    /* Shaders are precompiled on a private pool, so that a burst of shader
+     * creations can't take over the process thread pool. Without it, shaders
+     * are just compiled when they are first used. */
+    memset(&priv->compile_environment, 0, sizeof(priv->compile_environment));
+    priv->compile_environment.Version = 1;
+    if ((priv->compile_pool = CreateThreadpool(NULL)))
+    {
+        SetThreadpoolThreadMaximum(priv->compile_pool, SHADER_SPIRV_COMPILE_THREADS_MAX);
+        priv->compile_environment.Pool = priv->compile_pool;
+    }
+    else
+    {
+        WARN("Failed to create shader compilation thread pool.\n");
+    }
+
     device->vertex_priv = vertex_priv;
     device->fragment_priv = fragment_priv;
     device->shader_priv = priv;
@@ -1003,6 +1182,8 @@ static void shader_spirv_free(struct wined3d_device *device, struct wined3d_cont
 {
     struct shader_spirv_priv *priv = device->shader_priv;
 
+    if (priv->compile_pool)
+        CloseThreadpool(priv->compile_pool);
     shader_spirv_resource_bindings_cleanup(&priv->bindings);
     priv->fragment_pipe->free_private(device, context);
     priv->vertex_pipe->vp_free(device, context);
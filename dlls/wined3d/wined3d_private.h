@@ -3636,6 +3636,15 @@ struct wined3d_cs
     LONG waiting_for_event;
     LONG waiting_for_present;
     LONG pending_presents;
+
+    /* Client side queue statistics, reported on present. */
+    struct
+    {
+        unsigned int packets;
+        unsigned int wakeups;
+        unsigned int stalls;
+        LONGLONG stall_time;
+    } stats;
 };
 
 static inline void wined3d_device_context_lock(struct wined3d_device_context *context)
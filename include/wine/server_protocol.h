@@ -1993,10 +1993,10 @@ struct get_mapping_info_reply
     mem_size_t   size;
     unsigned int flags;
     obj_handle_t shared_file;
+    obj_handle_t reloc_file;
     data_size_t  total;
     /* VARARG(image,pe_image_info); */
     /* VARARG(name,unicode_str); */
-    char __pad_28[4];
 };
 
 
@@ -6721,7 +6721,7 @@ union generic_reply
 
 /* ### protocol_version begin ### */
 
-#define SERVER_PROTOCOL_VERSION 1795
+#define SERVER_PROTOCOL_VERSION 1796
 
 /* ### protocol_version end ### */
 
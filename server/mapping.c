@@ -126,6 +126,48 @@ static const struct object_ops shared_map_ops =
 
 static struct list shared_map_list = LIST_INIT( shared_map_list );
 
+/* file holding the sections of a PE image relocated to its dynamic base */
+struct reloc_map
+{
+    struct object   obj;             /* object header */
+    struct fd      *fd;              /* file descriptor of the mapped PE file */
+    struct file    *file;            /* temp file holding the relocated sections */
+    client_ptr_t    base;            /* address the sections are relocated to */
+    char            tmp_name[16];    /* name of temp file */
+    struct list     entry;           /* entry in global reloc maps list */
+};
+
+static void reloc_map_dump( struct object *obj, int verbose );
+static void reloc_map_destroy( struct object *obj );
+
+static const struct object_ops reloc_map_ops =
+{
+    sizeof(struct reloc_map),  /* size */
+    &no_type,                  /* type */
+    reloc_map_dump,            /* dump */
+    no_add_queue,              /* add_queue */
+    NULL,                      /* remove_queue */
+    NULL,                      /* signaled */
+    NULL,                      /* get_esync_fd */
+    NULL,                      /* get_msync_idx */
+    NULL,                      /* satisfied */
+    no_signal,                 /* signal */
+    no_get_fd,                 /* get_fd */
+    default_map_access,        /* map_access */
+    default_get_sd,            /* get_sd */
+    default_set_sd,            /* set_sd */
+    no_get_full_name,          /* get_full_name */
+    no_lookup_name,            /* lookup_name */
+    no_link_name,              /* link_name */
+    NULL,                      /* unlink_name */
+    no_open_file,              /* open_file */
+    no_kernel_obj_list,        /* get_kernel_obj_list */
+    no_close_handle,           /* close_handle */
+    reloc_map_destroy          /* destroy */
+};
+
+static struct list reloc_map_list = LIST_INIT( reloc_map_list );
+
 /* memory view mapped in client address space */
 struct memory_view
 {
@@ -133,6 +175,7 @@ struct memory_view
     struct fd      *fd;              /* fd for mapped file */
     struct ranges  *committed;       /* list of committed ranges in this mapping */
     struct shared_map *shared;       /* temp file for shared PE mapping */
+    struct reloc_map *reloc;         /* temp file for relocated PE mapping */
     pe_image_info_t image;           /* image info (for PE image mapping) */
     unsigned int    flags;           /* SEC_* flags */
     client_ptr_t    base;            /* view base address (in process addr space) */
@@ -167,6 +210,7 @@ struct mapping
     char            tmp_name[16];    /* name of temp file if any */
     struct ranges  *committed;       /* list of committed ranges in this mapping */
     struct shared_map *shared;       /* temp file for shared PE mapping */
+    struct reloc_map *reloc;         /* temp file for relocated PE mapping */
 };
 
 static void mapping_dump( struct object *obj, int verbose );
@@ -230,6 +274,8 @@ struct addr_range
 
 static size_t page_mask;
 static const mem_size_t granularity_mask = 0xffff;
+/* largest image the server relocates itself, the client handles the bigger ones */
+static const mem_size_t max_reloc_map_size = 32 * 1024 * 1024;
 static struct addr_range ranges32;
 static struct addr_range ranges64;
 
@@ -272,6 +318,23 @@ static void shared_map_destroy( struct object *obj )
     list_remove( &shared->entry );
 }
 
+static void reloc_map_dump( struct object *obj, int verbose )
+{
+    struct reloc_map *reloc = (struct reloc_map *)obj;
+    fprintf( stderr, "Relocated mapping fd=%p file=%p base=%08x%08x\n", reloc->fd, reloc->file,
+             (unsigned int)(reloc->base >> 32), (unsigned int)reloc->base );
+}
+
+static void reloc_map_destroy( struct object *obj )
+{
+    struct reloc_map *reloc = (struct reloc_map *)obj;
+
+    unlink_temp_file( reloc->tmp_name );
+    release_object( reloc->fd );
+    release_object( reloc->file );
+    list_remove( &reloc->entry );
+}
+
 /* extend a file beyond the current end of file */
 int grow_file( int unix_fd, file_pos_t new_size )
 {
@@ -475,6 +538,7 @@ static void free_memory_view( struct memory_view *view )
     if (view->fd) release_object( view->fd );
     if (view->committed) release_object( view->committed );
     if (view->shared) release_object( view->shared );
+    if (view->reloc) release_object( view->reloc );
     list_remove( &view->entry );
     free( view );
 }
@@ -499,6 +563,17 @@ static struct shared_map *get_shared_file( struct fd *fd )
     return NULL;
 }
 
+/* find the relocated PE mapping for a given mapping */
+static struct reloc_map *get_reloc_file( struct fd *fd, client_ptr_t base )
+{
+    struct reloc_map *ptr;
+
+    LIST_FOR_EACH_ENTRY( ptr, &reloc_map_list, struct reloc_map, entry )
+        if (ptr->base == base && is_same_file_fd( ptr->fd, fd ))
+            return (struct reloc_map *)grab_object( ptr );
+    return NULL;
+}
+
 /* return the size of the memory mapping and file range of a given section */
 static inline void get_section_sizes( const IMAGE_SECTION_HEADER *sec, size_t *map_size,
                                       off_t *file_start, size_t *file_size )
@@ -687,6 +762,160 @@ static int build_shared_mapping( struct mapping *mapping, int fd,
     return 0;
 }
 
+/* check if a range of a relocated image is backed by the data copied from the file */
+static int is_reloc_range_mapped( const IMAGE_SECTION_HEADER *sec, unsigned int nb_sec,
+                                  size_t va, size_t size )
+{
+    size_t map_size, file_size;
+    off_t file_start;
+    unsigned int i;
+
+    for (i = 0; i < nb_sec; i++)
+    {
+        if ((sec[i].Characteristics & IMAGE_SCN_MEM_SHARED) &&
+            (sec[i].Characteristics & IMAGE_SCN_MEM_WRITE)) continue;
+        if (!sec[i].PointerToRawData) continue;
+        get_section_sizes( &sec[i], &map_size, &file_start, &file_size );
+        if (va < sec[i].VirtualAddress) continue;
+        if (va - sec[i].VirtualAddress + size <= ROUND_SIZE( file_size )) return 1;
+    }
+    return 0;
+}
+
+/* apply a block of base relocations, the same way the client would do it */
+static const IMAGE_BASE_RELOCATION *relocate_block( char *base, const IMAGE_SECTION_HEADER *sec,
+                                                    unsigned int nb_sec, const IMAGE_BASE_RELOCATION *rel,
+                                                    client_ptr_t delta )
+{
+    const USHORT *reloc = (const USHORT *)(rel + 1);
+    char *page = base + rel->VirtualAddress;
+    unsigned int count;
+
+    if (!is_reloc_range_mapped( sec, nb_sec, rel->VirtualAddress, 0x1000 )) return NULL;
+
+    for (count = (rel->SizeOfBlock - sizeof(*rel)) / sizeof(USHORT); count; count--, reloc++)
+    {
+        USHORT offset = *reloc & 0xfff;
+        switch (*reloc >> 12)
+        {
+        case IMAGE_REL_BASED_ABSOLUTE:
+            break;
+        case IMAGE_REL_BASED_HIGH:
+            if (offset > 0x1000 - sizeof(short) &&
+                !is_reloc_range_mapped( sec, nb_sec, rel->VirtualAddress + offset, sizeof(short) ))
+                return NULL;
+            *(short *)(page + offset) += HIWORD(delta);
+            break;
+        case IMAGE_REL_BASED_LOW:
+            if (offset > 0x1000 - sizeof(short) &&
+                !is_reloc_range_mapped( sec, nb_sec, rel->VirtualAddress + offset, sizeof(short) ))
+                return NULL;
+            *(short *)(page + offset) += LOWORD(delta);
+            break;
+        case IMAGE_REL_BASED_HIGHLOW:
+            if (offset > 0x1000 - sizeof(int) &&
+                !is_reloc_range_mapped( sec, nb_sec, rel->VirtualAddress + offset, sizeof(int) ))
+                return NULL;
+            *(int *)(page + offset) += delta;
+            break;
+        case IMAGE_REL_BASED_DIR64:
+            if (offset > 0x1000 - sizeof(INT64) &&
+                !is_reloc_range_mapped( sec, nb_sec, rel->VirtualAddress + offset, sizeof(INT64) ))
+                return NULL;
+            *(INT64 *)(page + offset) += delta;
+            break;
+        default:
+            return NULL;
+        }
+    }
+    return (const IMAGE_BASE_RELOCATION *)reloc;  /* return address of next block */
+}
+
+/* allocate and fill the temp file for a relocated PE image mapping
+ *
+ * Processes that map the image at its dynamic base then share the relocated
+ * pages instead of each applying the relocations to a private copy. */
+static void build_reloc_mapping( struct mapping *mapping, int fd, IMAGE_SECTION_HEADER *sec,
+                                 unsigned int nb_sec, size_t reloc_va, size_t reloc_size )
+{
+    struct reloc_map *reloc;
+    struct file *file = NULL;
+    const IMAGE_BASE_RELOCATION *rel, *end;
+    client_ptr_t delta = mapping->image.map_addr - mapping->image.base;
+    mem_size_t total_size = mapping->image.map_size;
+    size_t map_size, file_size;
+    off_t read_pos;
+    char *ptr = MAP_FAILED;
+    char tmp_name[16];
+    unsigned int i;
+    int reloc_fd;
+
+    /* the client has more work to do for the other machines, leave it to it */
+    if (mapping->image.machine != IMAGE_FILE_MACHINE_I386 &&
+        mapping->image.machine != IMAGE_FILE_MACHINE_AMD64) return;
+    if (native_machine != IMAGE_FILE_MACHINE_I386 && native_machine != IMAGE_FILE_MACHINE_AMD64) return;
+
+    if ((mapping->reloc = get_reloc_file( mapping->fd, mapping->image.map_addr ))) return;
+
+    /* the whole image is read and relocated while handling the request, don't stall
+     * the other clients for too long; this happens once per file and map address */
+    if (total_size > max_reloc_map_size) return;
+
+    if (!is_reloc_range_mapped( sec, nb_sec, reloc_va, reloc_size )) return;
+
+    /* create a temp file with the sections at their virtual address */
+
+    if ((reloc_fd = create_temp_file( total_size, tmp_name )) == -1) goto error;
+    if (!(file = create_file_for_fd( reloc_fd, FILE_GENERIC_READ|FILE_GENERIC_WRITE, 0 ))) goto error;
+    ptr = mmap( NULL, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, reloc_fd, 0 );
+    if (ptr == MAP_FAILED) goto error;
+
+    for (i = 0; i < nb_sec; i++)
+    {
+        if ((sec[i].Characteristics & IMAGE_SCN_MEM_SHARED) &&
+            (sec[i].Characteristics & IMAGE_SCN_MEM_WRITE)) continue;
+        if (!sec[i].PointerToRawData) continue;
+        get_section_sizes( &sec[i], &map_size, &read_pos, &file_size );
+        if (!file_size) continue;
+        /* same checks as the client, it will fail to load the image otherwise */
+        if (sec[i].PointerToRawData >= mapping->image.file_size) goto error;
+        if (read_pos + file_size > ((mapping->image.file_size + 0x1ff) & ~0x1ff)) goto error;
+        if (sec[i].VirtualAddress > total_size || ROUND_SIZE( file_size ) > total_size - sec[i].VirtualAddress)
+            goto error;
+        if (pread( fd, ptr + sec[i].VirtualAddress, file_size, read_pos ) <= 0) goto error;
+    }
+
+    /* apply the relocations */
+
+    rel = (const IMAGE_BASE_RELOCATION *)(ptr + reloc_va);
+    end = (const IMAGE_BASE_RELOCATION *)(ptr + reloc_va + reloc_size);
+    while (rel < end - 1 && rel->SizeOfBlock && rel->VirtualAddress < total_size)
+    {
+        if (rel->SizeOfBlock < sizeof(*rel) || rel->SizeOfBlock > (char *)end - (char *)rel) goto error;
+        if (!(rel = relocate_block( ptr, sec, nb_sec, rel, delta ))) goto error;
+    }
+    munmap( ptr, total_size );
+
+    if (!(reloc = alloc_object( &reloc_map_ops ))) goto error;
+    reloc->fd = (struct fd *)grab_object( mapping->fd );
+    reloc->file = file;
+    reloc->base = mapping->image.map_addr;
+    strcpy( reloc->tmp_name, tmp_name );
+    list_add_head( &reloc_map_list, &reloc->entry );
+    mapping->reloc = reloc;
+    return;
+
+ error:
+    /* the client will relocate the image itself */
+    if (ptr != MAP_FAILED) munmap( ptr, total_size );
+    if (file)
+    {
+        release_object( file );
+        unlink_temp_file( tmp_name );
+    }
+    clear_error();
+}
+
 /* load the CLR header from its section */
 static int load_clr_header( IMAGE_COR20_HEADER *hdr, size_t va, size_t size, int unix_fd,
                             IMAGE_SECTION_HEADER *sec, unsigned int nb_sec )
@@ -742,7 +971,7 @@ static unsigned int get_image_params( struct mapping *mapping, file_pos_t file_s
     } nt;
     off_t pos;
     int size, has_relocs;
-    size_t mz_size, clr_va = 0, clr_size = 0;
+    size_t mz_size, clr_va = 0, clr_size = 0, reloc_va = 0, reloc_size = 0;
     unsigned int i;
 
     /* load the headers */
@@ -808,6 +1037,11 @@ static unsigned int get_image_params( struct mapping *mapping, file_pos_t file_s
                       nt.opt.hdr32.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress &&
                       nt.opt.hdr32.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size &&
                       !(nt.FileHeader.Characteristics & IMAGE_FILE_RELOCS_STRIPPED));
+        if (has_relocs)
+        {
+            reloc_va = nt.opt.hdr32.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress;
+            reloc_size = nt.opt.hdr32.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size;
+        }
         if (nt.opt.hdr32.SectionAlignment & page_mask)
             mapping->image.image_flags |= IMAGE_FLAGS_ImageMappedFlat;
         else if ((nt.opt.hdr32.DllCharacteristics & IMAGE_DLLCHARACTERISTICS_DYNAMIC_BASE) &&
@@ -856,6 +1090,11 @@ static unsigned int get_image_params( struct mapping *mapping, file_pos_t file_s
                       nt.opt.hdr64.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress &&
                       nt.opt.hdr64.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size &&
                       !(nt.FileHeader.Characteristics & IMAGE_FILE_RELOCS_STRIPPED));
+        if (has_relocs)
+        {
+            reloc_va = nt.opt.hdr64.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress;
+            reloc_size = nt.opt.hdr64.DataDirectory[IMAGE_DIRECTORY_ENTRY_BASERELOC].Size;
+        }
         if (nt.opt.hdr64.SectionAlignment & page_mask)
             mapping->image.image_flags |= IMAGE_FLAGS_ImageMappedFlat;
         else if ((nt.opt.hdr64.DllCharacteristics & IMAGE_DLLCHARACTERISTICS_DYNAMIC_BASE) &&
@@ -911,6 +1150,12 @@ static unsigned int get_image_params( struct mapping *mapping, file_pos_t file_s
     if (!build_shared_mapping( mapping, unix_fd, sec, nt.FileHeader.NumberOfSections ))
         return STATUS_INVALID_FILE_FOR_SECTION;
 
+    /* the image has already been mapped by some process, the relocations will be the same */
+    if (mapping->image.map_addr && mapping->image.map_addr != mapping->image.base && reloc_size &&
+        (mapping->image.image_flags & IMAGE_FLAGS_ImageDynamicallyRelocated) &&
+        !is_fd_removable( mapping->fd ))
+        build_reloc_mapping( mapping, unix_fd, sec, nt.FileHeader.NumberOfSections, reloc_va, reloc_size );
+
     return STATUS_SUCCESS;
 }
 
@@ -970,6 +1215,7 @@ static struct mapping *create_mapping( struct object *root, const struct unicode
     mapping->size        = size;
     mapping->fd          = NULL;
     mapping->shared      = NULL;
+    mapping->reloc       = NULL;
     mapping->committed   = NULL;
     mapping->tmp_name[0] = 0;
 
@@ -1060,6 +1306,7 @@ struct mapping *create_fd_mapping( struct object *root, const struct unicode_str
     if (get_error() == STATUS_OBJECT_NAME_EXISTS) return mapping;  /* Nothing else to do */
 
     mapping->shared    = NULL;
+    mapping->reloc     = NULL;
     mapping->committed = NULL;
     mapping->flags     = SEC_FILE;
     mapping->fd        = (struct fd *)grab_object( fd );
@@ -1173,6 +1420,7 @@ static void mapping_destroy( struct object *obj )
     if (mapping->fd) release_object( mapping->fd );
     if (mapping->committed) release_object( mapping->committed );
     if (mapping->shared) release_object( mapping->shared );
+    if (mapping->reloc) release_object( mapping->reloc );
 }
 
 static enum server_fd_type mapping_get_fd_type( struct fd *fd )
@@ -1336,6 +1584,8 @@ DECL_HANDLER(get_mapping_info)
     if (mapping->shared)
         reply->shared_file = alloc_handle( current->process, mapping->shared->file,
                                            GENERIC_READ|GENERIC_WRITE, 0 );
+    if (mapping->reloc)
+        reply->reloc_file = alloc_handle( current->process, mapping->reloc->file, GENERIC_READ, 0 );
     release_object( mapping );
 }
 
@@ -1390,6 +1640,7 @@ DECL_HANDLER(map_view)
         view->fd        = !is_fd_removable( mapping->fd ) ? (struct fd *)grab_object( mapping->fd ) : NULL;
         view->committed = mapping->committed ? (struct ranges *)grab_object( mapping->committed ) : NULL;
         view->shared    = NULL;
+        view->reloc     = NULL;
         add_process_view( current, view );
     }
 
@@ -1427,6 +1678,7 @@ DECL_HANDLER(map_image_view)
         view->fd        = !is_fd_removable( mapping->fd ) ? (struct fd *)grab_object( mapping->fd ) : NULL;
         view->committed = NULL;
         view->shared    = mapping->shared ? (struct shared_map *)grab_object( mapping->shared ) : NULL;
+        view->reloc     = mapping->reloc ? (struct reloc_map *)grab_object( mapping->reloc ) : NULL;
         view->image     = mapping->image;
         view->image.machine     = req->machine;
         view->image.entry_point = req->entry;
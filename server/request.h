@@ -1165,7 +1165,8 @@ C_ASSERT( sizeof(struct get_mapping_info_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, size) == 8 );
 C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, flags) == 16 );
 C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, shared_file) == 20 );
-C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, total) == 24 );
+C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, reloc_file) == 24 );
+C_ASSERT( FIELD_OFFSET(struct get_mapping_info_reply, total) == 28 );
 C_ASSERT( sizeof(struct get_mapping_info_reply) == 32 );
 C_ASSERT( FIELD_OFFSET(struct get_image_map_address_request, handle) == 12 );
 C_ASSERT( sizeof(struct get_image_map_address_request) == 16 );